@@ -0,0 +1,116 @@
+//
+//  BitPacking.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef BitPacking_hpp
+#define BitPacking_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace BitPacking
+{
+
+// Values are stored least significant bit first. Reads are
+// done with a single unaligned 64-bit load so a field can be
+// at most 57 bits wide and buffers must be followed by
+// kPadding bytes to keep the final load in bounds
+constexpr size_t kMaxBits = 57;
+constexpr size_t kPadding = sizeof(uint64_t);
+
+static inline uint64_t
+Read(
+    const uint8_t* const Base,
+    const size_t BitOffset,
+    const size_t Bits
+)
+{
+    uint64_t value;
+    memcpy(&value, Base + (BitOffset >> 3), sizeof(value));
+    value >>= (BitOffset & 7);
+    return value & ((1ull << Bits) - 1);
+}
+
+// The number of bits needed to store any value up to
+// and including Value
+static inline size_t
+BitsRequired(
+    const uint64_t Value
+)
+{
+    return Value == 0 ? 1 : 64 - __builtin_clzll(Value);
+}
+
+// Buffers packed values and writes them out to a file handle
+// in large chunks
+class BitWriter
+{
+public:
+    BitWriter(FILE* Handle) : m_Handle(Handle) { m_Buffer.reserve(kFlushSize + kPadding); };
+    ~BitWriter(void) { Flush(true); }
+    void Write(
+        const uint64_t Value,
+        const size_t Bits
+    )
+    {
+        for (size_t written = 0; written < Bits;)
+        {
+            if (m_Used == 0)
+            {
+                m_Buffer.push_back(0);
+            }
+            const size_t chunk = std::min(Bits - written, (size_t)8 - m_Used);
+            const uint8_t part = (Value >> written) & ((1u << chunk) - 1);
+            m_Buffer.back() |= part << m_Used;
+            m_Used = (m_Used + chunk) % 8;
+            written += chunk;
+        }
+        m_BitsWritten += Bits;
+        if (m_Buffer.size() >= kFlushSize && m_Used == 0)
+        {
+            Flush(false);
+        }
+    }
+    // Writing the final block pads the output so that
+    // it can be safely read back with Read
+    void Flush(
+        const bool Final
+    )
+    {
+        if (Final)
+        {
+            if (m_Handle == nullptr)
+            {
+                return;
+            }
+            m_Buffer.resize(m_Buffer.size() + kPadding, 0);
+        }
+        fwrite(m_Buffer.data(), sizeof(uint8_t), m_Buffer.size(), m_Handle);
+        m_Buffer.clear();
+        m_Used = 0;
+        if (Final)
+        {
+            fflush(m_Handle);
+            m_Handle = nullptr;
+        }
+    }
+    const size_t BitsWritten(void) const { return m_BitsWritten; }
+private:
+    static constexpr size_t kFlushSize = 1024 * 1024;
+    FILE* m_Handle;
+    std::vector<uint8_t> m_Buffer;
+    size_t m_Used = 0;
+    size_t m_BitsWritten = 0;
+};
+
+}
+
+#endif /* BitPacking_hpp */
@@ -0,0 +1,78 @@
+//
+//  EndpointKey.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef EndpointKey_hpp
+#define EndpointKey_hpp
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Maps null-padded endpoints to integers which sort in the same
+// order as memcmp. Each byte is replaced by its rank in the
+// charset (nulls rank lowest) and the ranks are read as digits
+// of a number in base charset size + 1. As many leading bytes
+// are used as will fit in 64 bits. If that covers the whole
+// endpoint the key is exact, otherwise it is a prefix key
+class EndpointKey
+{
+public:
+    EndpointKey(void) = default;
+    EndpointKey(
+        const std::string& Charset,
+        const size_t Max
+    )
+    {
+        m_Ranks.fill(0);
+        for (const char c : Charset)
+        {
+            m_Ranks[(uint8_t)c] = 1;
+        }
+        // Ranks follow byte order rather than charset order
+        uint64_t rank = 0;
+        for (size_t i = 0; i < m_Ranks.size(); i++)
+        {
+            if (m_Ranks[i] != 0)
+            {
+                m_Ranks[i] = ++rank;
+            }
+        }
+        m_Radix = rank + 1;
+
+        // Find how many bytes we can fit
+        uint64_t range = 1;
+        m_Width = 0;
+        while (m_Width < Max && !__builtin_mul_overflow(range, m_Radix, &range))
+        {
+            m_Width++;
+        }
+        m_Exact = m_Width == Max;
+    }
+    const uint64_t Key(
+        const uint8_t* const Endpoint
+    ) const
+    {
+        uint64_t key = 0;
+        for (size_t i = 0; i < m_Width; i++)
+        {
+            key = key * m_Radix + m_Ranks[Endpoint[i]];
+        }
+        return key;
+    }
+    const bool Exact(void) const { return m_Exact; }
+    const size_t Width(void) const { return m_Width; }
+    const uint64_t Radix(void) const { return m_Radix; }
+private:
+    std::array<uint8_t, 256> m_Ranks{};
+    uint64_t m_Radix = 1;
+    size_t m_Width = 0;
+    bool m_Exact = false;
+};
+
+#endif /* EndpointKey_hpp */
@@ -0,0 +1,79 @@
+//
+//  Filter.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef Filter_hpp
+#define Filter_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A blocked Bloom filter. Each key sets one bit in each of the
+// eight words of a single cache line sized block, so a lookup
+// costs one cache miss regardless of the number of bits set.
+// Keys are expected to already be well mixed hashes
+class BlockedBloomFilter
+{
+public:
+    void Init(
+        const size_t Keys,
+        const size_t BitsPerKey
+    )
+    {
+        const size_t blocks = std::max(Keys * BitsPerKey / (sizeof(Block) * 8), (size_t)1);
+        m_Blocks.assign(blocks, Block{});
+    }
+
+    void Insert(
+        const uint64_t Hash
+    )
+    {
+        Block& block = m_Blocks[BlockFor(Hash)];
+        const uint64_t bits = Rehash(Hash);
+        for (size_t i = 0; i < kWords; i++)
+        {
+            block.words[i] |= 1ull << ((bits >> (16 + i * 6)) & 63);
+        }
+    }
+
+    const bool Contains(
+        const uint64_t Hash
+    ) const
+    {
+        const Block& block = m_Blocks[BlockFor(Hash)];
+        const uint64_t bits = Rehash(Hash);
+        uint64_t missing = 0;
+        for (size_t i = 0; i < kWords; i++)
+        {
+            missing |= ~block.words[i] & (1ull << ((bits >> (16 + i * 6)) & 63));
+        }
+        return missing == 0;
+    }
+
+    const bool Enabled(void) const { return !m_Blocks.empty(); }
+    const size_t SizeBytes(void) const { return m_Blocks.size() * sizeof(Block); }
+    const void* Data(void) const { return m_Blocks.data(); }
+    void Clear(void) { m_Blocks.clear(); m_Blocks.shrink_to_fit(); }
+private:
+    static constexpr size_t kWords = 8;
+    typedef struct alignas(64) _Block
+    {
+        uint64_t words[kWords];
+    } Block;
+
+    // Multiply-shift maps the hash onto the blocks without a division
+    inline size_t BlockFor(const uint64_t Hash) const { return (size_t)(((unsigned __int128)Hash * m_Blocks.size()) >> 64); }
+    // The block index uses the high bits so derive the bit
+    // positions from the upper bits of a second mix of the hash
+    static inline uint64_t Rehash(const uint64_t Hash) { return (Hash ^ (Hash >> 29)) * 0xbf58476d1ce4e5b9ull; }
+
+    std::vector<Block> m_Blocks;
+};
+
+#endif /* Filter_hpp */
@@ -0,0 +1,67 @@
+//
+//  HyperLogLog.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef HyperLogLog_hpp
+#define HyperLogLog_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Estimates the number of distinct keys seen in a fixed 16KB,
+// with a standard error of about 0.8%. Keys are expected to
+// already be well mixed hashes
+class HyperLogLog
+{
+public:
+    HyperLogLog(void) : m_Registers(kRegisters, 0) {}
+
+    void Insert(
+        const uint64_t Hash
+    )
+    {
+        // The top bits pick a register, which keeps the longest
+        // run of leading zeros seen in the remaining bits
+        const size_t index = Hash >> (64 - kBits);
+        const uint64_t rest = (Hash << kBits) | (1ull << (kBits - 1));
+        const uint8_t rank = __builtin_clzll(rest) + 1;
+        m_Registers[index] = std::max(m_Registers[index], rank);
+    }
+
+    double Estimate(
+        void
+    ) const
+    {
+        double sum = 0.0;
+        size_t zeros = 0;
+        for (const uint8_t rank : m_Registers)
+        {
+            sum += std::ldexp(1.0, -rank);
+            zeros += rank == 0;
+        }
+        const double registers = kRegisters;
+        const double alpha = 0.7213 / (1.0 + 1.079 / registers);
+        const double estimate = alpha * registers * registers / sum;
+        // Small counts leave registers empty, where counting
+        // the empty ones is more accurate
+        if (estimate <= 2.5 * registers && zeros > 0)
+        {
+            return registers * std::log(registers / zeros);
+        }
+        return estimate;
+    }
+private:
+    static constexpr size_t kBits = 14;
+    static constexpr size_t kRegisters = (size_t)1 << kBits;
+
+    std::vector<uint8_t> m_Registers;
+};
+
+#endif /* HyperLogLog_hpp */
@@ -0,0 +1,219 @@
+//
+//  LearnedIndex.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef LearnedIndex_hpp
+#define LearnedIndex_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+// A piecewise linear model of the position of a key in a sorted
+// array of keys. Reduced endpoints are close to uniform so the key
+// space is split into equal width segments, each of which stores
+// the position of its first key, a slope and the largest error
+// seen when predicting the position of any key in the segment.
+// A lookup then only needs to search a window of a few records
+class LearnedIndex
+{
+public:
+    // Roughly this many keys are modelled by each segment
+    static constexpr size_t kKeysPerSegment = 256;
+
+    void Train(
+        const uint64_t* const Keys,
+        const size_t Count
+    )
+    {
+        m_Count = Count;
+        m_Checksum = Checksum(Keys, Count);
+        m_Segments.clear();
+        if (Count == 0)
+        {
+            return;
+        }
+
+        m_Min = Keys[0];
+        m_Max = Keys[Count - 1];
+        const uint64_t range = Keys[Count - 1] - m_Min;
+        const uint64_t width = std::max(range / std::max(Count / kKeysPerSegment, (size_t)1), (uint64_t)1);
+        m_Shift = 63 - __builtin_clzll(width);
+        const size_t segments = (range >> m_Shift) + 1;
+
+        // Record where each segment starts. The extra segment
+        // marks the end of the array
+        m_Segments.resize(segments + 1, {Count, 0.0f, 0});
+        for (size_t i = Count; i-- > 0;)
+        {
+            m_Segments[SegmentFor(Keys[i])].first = i;
+        }
+        // Empty segments start where the next one does
+        for (size_t s = segments; s-- > 0;)
+        {
+            m_Segments[s].first = std::min(m_Segments[s].first, m_Segments[s + 1].first);
+        }
+
+        for (size_t s = 0; s < segments; s++)
+        {
+            m_Segments[s].slope = (float)(m_Segments[s + 1].first - m_Segments[s].first) / (float)(1ull << m_Shift);
+        }
+
+        // Measure the error using the same arithmetic as lookups
+        for (size_t i = 0; i < Count; i++)
+        {
+            const size_t s = SegmentFor(Keys[i]);
+            const size_t predicted = Predict(Keys[i], s);
+            const size_t error = predicted > i ? predicted - i : i - predicted;
+            m_Segments[s].error = std::max(m_Segments[s].error, (uint32_t)std::min(error, (size_t)UINT32_MAX));
+        }
+    }
+
+    // Returns a range of positions which is guaranteed to contain
+    // the first key that is not less than Key
+    std::pair<size_t, size_t> Range(
+        const uint64_t Key
+    ) const
+    {
+        if (m_Segments.empty() || Key <= m_Min)
+        {
+            return {0, 0};
+        }
+        const size_t s = SegmentFor(Key);
+        if (s >= m_Segments.size() - 1)
+        {
+            return {m_Count, m_Count};
+        }
+
+        // Keys between two stored keys can be predicted one
+        // position either side of them
+        const Segment& segment = m_Segments[s];
+        const size_t predicted = Predict(Key, s);
+        const size_t error = (size_t)segment.error + 1;
+        const size_t first = std::max(predicted > error ? predicted - error : 0, segment.first);
+        const size_t last = std::min(predicted + error + 1, m_Segments[s + 1].first);
+        return {std::min(first, last), last};
+    }
+
+    // Models are saved alongside the table so that they only
+    // need to be trained once
+    bool Save(
+        const std::filesystem::path& Path
+    ) const
+    {
+        FILE* fh = fopen(Path.c_str(), "w");
+        if (fh == nullptr)
+        {
+            return false;
+        }
+        const FileHeader header = {{'L', 'I', 'D', 'X', '0', '0', '0', '2'}, m_Count, m_Min, m_Max, m_Checksum, m_Shift, m_Segments.size()};
+        bool result = fwrite(&header, sizeof(header), 1, fh) == 1;
+        result &= fwrite(m_Segments.data(), sizeof(Segment), m_Segments.size(), fh) == m_Segments.size();
+        fclose(fh);
+        return result;
+    }
+
+    // The key range and a checksum of every key are checked to
+    // catch a model left behind by a different or rebuilt table
+    bool Load(
+        const std::filesystem::path& Path,
+        const uint64_t* const Keys,
+        const size_t Count
+    )
+    {
+        FILE* fh = fopen(Path.c_str(), "r");
+        if (fh == nullptr)
+        {
+            return false;
+        }
+        FileHeader header;
+        bool result = fread(&header, sizeof(header), 1, fh) == 1;
+        result &= memcmp(header.magic, "LIDX0002", sizeof(header.magic)) == 0 && header.count == Count && header.shift < 64;
+        result &= Count == 0 || (header.min == Keys[0] && header.max == Keys[Count - 1]);
+        result &= header.checksum == Checksum(Keys, Count);
+        if (result)
+        {
+            m_Segments.resize(header.segments);
+            result = fread(m_Segments.data(), sizeof(Segment), m_Segments.size(), fh) == m_Segments.size();
+        }
+        fclose(fh);
+        if (!result)
+        {
+            m_Segments.clear();
+            return false;
+        }
+        m_Count = header.count;
+        m_Min = header.min;
+        m_Max = header.max;
+        m_Checksum = header.checksum;
+        m_Shift = header.shift;
+        return true;
+    }
+
+    void Clear(void) { m_Segments.clear(); m_Count = 0; m_Min = 0; m_Max = 0; m_Checksum = 0; m_Shift = 0; }
+    const bool Trained(void) const { return !m_Segments.empty(); }
+    const size_t Segments(void) const { return m_Segments.empty() ? 0 : m_Segments.size() - 1; }
+private:
+    typedef struct _Segment
+    {
+        uint64_t first;
+        float slope;
+        uint32_t error;
+    } Segment;
+    static_assert(sizeof(Segment) == 16);
+
+    typedef struct __attribute__((__packed__)) _FileHeader
+    {
+        char magic[8];
+        uint64_t count;
+        uint64_t min;
+        uint64_t max;
+        uint64_t checksum;
+        uint64_t shift;
+        uint64_t segments;
+    } FileHeader;
+
+    // Mixes every key into the running value so that changing or
+    // reordering any of them changes the result
+    static uint64_t Checksum(
+        const uint64_t* const Keys,
+        const size_t Count
+    )
+    {
+        uint64_t checksum = Count;
+        for (size_t i = 0; i < Count; i++)
+        {
+            checksum = (checksum ^ Keys[i]) * 0x9e3779b97f4a7c15ull;
+            checksum ^= checksum >> 32;
+        }
+        return checksum;
+    }
+
+    inline size_t SegmentFor(const uint64_t Key) const { return (Key - m_Min) >> m_Shift; }
+    inline size_t Predict(
+        const uint64_t Key,
+        const size_t Index
+    ) const
+    {
+        const uint64_t offset = (Key - m_Min) & ((1ull << m_Shift) - 1);
+        return m_Segments[Index].first + (size_t)(offset * m_Segments[Index].slope);
+    }
+
+    std::vector<Segment> m_Segments;
+    size_t m_Count = 0;
+    uint64_t m_Min = 0;
+    uint64_t m_Max = 0;
+    uint64_t m_Checksum = 0;
+    uint64_t m_Shift = 0;
+};
+
+#endif /* LearnedIndex_hpp */
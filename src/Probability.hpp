@@ -0,0 +1,61 @@
+//
+//  Probability.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef Probability_hpp
+#define Probability_hpp
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Probability
+{
+
+// The chance that a random word from the keyspace appears in each
+// column of a table. Merges mean column i only holds m_i distinct
+// words, where m_0 is the number of chains and
+// m_(i+1) = N * (1 - e^(-m_i / N)) for a keyspace of N words
+static inline std::vector<double>
+ColumnProbabilities(
+    const double Chains,
+    const size_t Length,
+    const double Keyspace
+)
+{
+    std::vector<double> columns(Length);
+    double distinct = Chains;
+    for (size_t i = 0; i < Length; i++)
+    {
+        columns[i] = distinct / Keyspace;
+        distinct = Keyspace * -std::expm1(-distinct / Keyspace);
+    }
+    return columns;
+}
+
+// The chance that searching the given columns finds a random word
+static inline double
+SuccessProbability(
+    const std::vector<double>& Columns,
+    const std::vector<uint8_t>& Searched
+)
+{
+    double miss = 1.0;
+    for (size_t i = 0; i < Columns.size() && i < Searched.size(); i++)
+    {
+        if (Searched[i])
+        {
+            miss *= 1.0 - Columns[i];
+        }
+    }
+    return 1.0 - miss;
+}
+
+}
+
+#endif /* Probability_hpp */
@@ -8,13 +8,18 @@
 
 #include <cinttypes>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <optional>
+#include <queue>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <sys/mman.h>
 #include <openssl/md5.h>
@@ -23,9 +28,11 @@
 
 #include "SimdHashBuffer.hpp"
 
+#include "BitPacking.hpp"
 #include "Chain.hpp"
 #include "Common.hpp"
 #include "RainbowTable.hpp"
+#include "Socket.hpp"
 #include "Util.hpp"
 
 void
@@ -48,7 +55,44 @@ RainbowTable::InitAndRunBuild(
     m_Operation = "Building";
 
     // Calculate the count if needed
-    if (m_Count == 0)
+    size_t estimate = m_Count;
+    if (m_TargetSuccess > 0)
+    {
+        if (m_TargetSuccess >= 1.0)
+        {
+            std::cerr << "Target success must be below 1" << std::endl;
+            return;
+        }
+
+        mpz_class keyspace = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset) - WordGenerator::WordLengthIndex(m_Min, m_Charset);
+        m_BuildKeyspace = keyspace.get_d();
+
+        // Search for the chains random walks would need. Merges
+        // only make this a lower bound, the build stops on the
+        // success estimated from the endpoints actually written
+        double low = 0.0;
+        double high = m_BuildKeyspace;
+        for (size_t i = 0; i < 64; i++)
+        {
+            const double middle = (low + high) / 2;
+            (BuildSuccess(middle, std::vector<double>(m_Family, 1.0)) < m_TargetSuccess ? low : high) = middle;
+        }
+        estimate = (size_t)high;
+        std::cerr << "Model chains for target: " << estimate;
+        if (m_Family > 1)
+        {
+            std::cerr << " in each of " << m_Family << " tables";
+        }
+        std::cerr << std::endl;
+
+        // Every chain starts from a different word so
+        // there is no point in more than the keyspace
+        if (m_Count == 0)
+        {
+            m_Count = keyspace.fits_ulong_p() ? keyspace.get_ui() : std::numeric_limits<size_t>::max();
+        }
+    }
+    else if (m_Count == 0)
     {
         mpz_class keyspace = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset) - WordGenerator::WordLengthIndex(m_Min, m_Charset);
         keyspace /= m_Length + 1;
@@ -56,35 +100,49 @@ RainbowTable::InitAndRunBuild(
         keyspace += (keyspace / 10);
         std::cerr << "Calculated chains required: " << keyspace.get_str() << std::endl;
         m_Count = keyspace.get_ui();
+        estimate = m_Count;
     }
 
     // Estimate table size
-    double tableSize = sizeof(TableHeader) + (m_Count * m_Max);
+    double tableSize = (sizeof(TableHeader) + (estimate * m_Max)) * m_Family;
     std::string tableSizeCh;
     tableSize = Util::SizeFactor(tableSize, tableSizeCh);
     std::cerr << "Estimated table size: " << std::fixed << std::setprecision(2) << tableSize << ' ' << tableSizeCh << " compressed (";
-    tableSize = sizeof(TableHeader) + (m_Count * (m_Max + sizeof(rowindex_t)));
+    tableSize = (sizeof(TableHeader) + (estimate * (m_Max + sizeof(rowindex_t)))) * m_Family;
     tableSize = Util::SizeFactor(tableSize, tableSizeCh);
     std::cerr << tableSize << ' ' << tableSizeCh << " uncompressed)" << std::endl;
 
     // Write the table header if we didn't load from disk
     if (!m_PathLoaded)
     {
-        StoreTableHeader();
+        StoreTableHeader(m_Path, m_TableIndex);
         m_HashWidth = GetHashWidth(m_Algorithm);
         m_ChainWidth = GetChainWidth();
         m_Chains = (std::filesystem::file_size(m_Path) - sizeof(TableHeader)) / m_ChainWidth;
     }
 
     m_StartingChains = m_Chains;
-
-    m_WriteHandle = fopen(m_Path.c_str(), "a");
-    if (m_WriteHandle == nullptr)
+    m_BuildStart = std::chrono::steady_clock::now();
+    // An earlier build on this object may have stopped at its target
+    m_ChainsWritten = 0;
+    m_BuildSuccess = 0.0;
+    m_EndpointEstimates.clear();
+    m_StopBlock = std::numeric_limits<size_t>::max();
+
+    if (!OpenFamily())
     {
-        std::cerr << "Unable to open table for writing" << std::endl;
         return;
     }
 
+    if (m_TargetSuccess > 0)
+    {
+        m_EndpointEstimates.assign(m_Family, HyperLogLog());
+        for (size_t member = 0; member < m_Family; member++)
+        {
+            SeedEndpointEstimate(member);
+        }
+    }
+
     // Create the main (io) dispatcher
     auto mainDispatcher = dispatch::CreateDispatcher(
         "main",
@@ -132,7 +190,7 @@ RainbowTable::GenerateBlock(
     size_t blockStartId = m_StartingChains + (m_Blocksize * BlockId);
 
     // Check if we should end
-    if (blockStartId >= m_Count)
+    if (blockStartId >= m_Count || BlockId >= m_StopBlock)
     {
         dispatch::PostTaskToDispatcher(
             "main",
@@ -145,9 +203,15 @@ RainbowTable::GenerateBlock(
         return;
     }
 
-    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset);
-    std::vector<SmallString> block(m_Blocksize);
+    std::vector<HybridReducer> reducers;
+    for (size_t member = 0; member < m_Family; member++)
+    {
+        reducers.emplace_back(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex + member);
+    }
+    // The chains of each member follow one another
+    std::vector<SmallString> block(m_Blocksize * m_Family);
 
+    std::array<SmallString, MAX_LANES> starts;
     SimdHashBufferFixed<MAX_LENGTH> words;
     std::array<uint8_t, MAX_HASH_SIZE * MAX_LANES> hashes;
 
@@ -166,37 +230,47 @@ RainbowTable::GenerateBlock(
     const size_t iterations = m_Blocksize / lanes;
     for (size_t iteration = 0; iteration < iterations; iteration++)
     {
-        // Set the chain start point
+        // Set the chain start point, shared by every member
         for (size_t i = 0; i < lanes; i++)
         {
-            const size_t length = WordGenerator::GenerateWord((char*)words[i], m_Max, counter++, m_Charset);
-            words.SetLength(i, length);
+            const size_t length = WordGenerator::GenerateWord(starts[i].Value, m_Max, counter++, m_Charset);
+            starts[i].SetLength(length);
         }
 
-        // Perform the hash/reduce cycle
-        for (size_t i = 0; i < m_Length; i++)
+        for (size_t member = 0; member < m_Family; member++)
         {
-            // Perform hash
-            SimdHashOptimized(
-                m_Algorithm,
-                words.GetLengths(),
-                words.ConstBuffers(),
-                &hashes[0]
-            );
+            const HybridReducer& reducer = reducers[member];
+            for (size_t i = 0; i < lanes; i++)
+            {
+                memcpy(words[i], starts[i].Value, starts[i].Length);
+                words.SetLength(i, starts[i].Length);
+            }
 
-            // Perform reduce
-            for (size_t h = 0; h < lanes; h++)
+            // Perform the hash/reduce cycle
+            for (size_t i = 0; i < m_Length; i++)
             {
-                const uint8_t* hash = &hashes[h * hashWidth];
-                const size_t length = reducer.Reduce((char*)words[h], m_Max, hash, i);
-                words.SetLength(h, length);
+                // Perform hash
+                SimdHashOptimized(
+                    m_Algorithm,
+                    words.GetLengths(),
+                    words.ConstBuffers(),
+                    &hashes[0]
+                );
+
+                // Perform reduce
+                for (size_t h = 0; h < lanes; h++)
+                {
+                    const uint8_t* hash = &hashes[h * hashWidth];
+                    const size_t length = reducer.Reduce((char*)words[h], m_Max, hash, i);
+                    words.SetLength(h, length);
+                }
             }
-        }
 
-        // Save the chain information
-        for (size_t h = 0; h < lanes; h++)
-        {
-            block[iteration * lanes + h].Set(words[h], words.GetLength(h));
+            // Save the chain information
+            for (size_t h = 0; h < lanes; h++)
+            {
+                block[member * m_Blocksize + iteration * lanes + h].Set(words[h], words.GetLength(h));
+            }
         }
     }
 
@@ -239,26 +313,35 @@ RainbowTable::WriteBlock(
     const std::vector<SmallString>& Block
 )
 {
-    // Create a byte buffer so we can do it on one shot
-    size_t bufferSize = m_ChainWidth * m_Blocksize;
-    std::vector<uint8_t> buffer(bufferSize);
-    uint8_t* bufferptr = &buffer[0];
-    size_t index = BlockId;
-    // Loop through the chains and add them to the buffer
-    for (auto& endpoint : Block)
+    // Each member of the family is written to its own table
+    for (size_t member = 0; member < m_Family; member++)
     {
-        if (m_TableType == TypeUncompressed)
+        // Create a byte buffer so we can do it on one shot
+        size_t bufferSize = m_ChainWidth * m_Blocksize;
+        std::vector<uint8_t> buffer(bufferSize);
+        uint8_t* bufferptr = &buffer[0];
+        size_t index = BlockId;
+        // Loop through the chains and add them to the buffer
+        for (size_t i = 0; i < m_Blocksize; i++)
         {
-            *((rowindex_t*)bufferptr) = index++;
-            bufferptr += sizeof(rowindex_t);
+            const SmallString& endpoint = Block[member * m_Blocksize + i];
+            if (m_TableType == TypeUncompressed)
+            {
+                *((rowindex_t*)bufferptr) = index++;
+                bufferptr += sizeof(rowindex_t);
+            }
+            memcpy(bufferptr, endpoint.Value, endpoint.Length);
+            if (m_TargetSuccess > 0)
+            {
+                m_EndpointEstimates[member].Insert(Util::Hash64(bufferptr, m_Max));
+            }
+            bufferptr += m_Max;
         }
-        memcpy(bufferptr, endpoint.Value, endpoint.Length);
-        bufferptr += m_Max;
+        // Perform the write in a single shot and flush
+        fwrite(&buffer[0], bufferSize, sizeof(uint8_t), m_WriteHandles[member]);
+        fflush(m_WriteHandles[member]);
     }
-    // Perform the write in a single shot and flush
-    fwrite(&buffer[0], bufferSize, sizeof(uint8_t), m_WriteHandle);
-    fflush(m_WriteHandle);
-    m_ChainsWritten += Block.size();
+    m_ChainsWritten += m_Blocksize;
 }
 
 void
@@ -287,6 +370,10 @@ RainbowTable::OutputStatus(
     chains = Util::NumFactor(chains, chainsChar);
 
     double percent = ((double)(m_StartingChains + m_ChainsWritten) / (double)m_Count) * 100.f;
+    if (m_TargetSuccess > 0)
+    {
+        percent = m_BuildSuccess / m_TargetSuccess * 100.f;
+    }
 
     char statusbuf[72];
     statusbuf[sizeof(statusbuf) - 1] = '\0';
@@ -339,27 +426,194 @@ RainbowTable::SaveBlock(
     {
         m_WriteCache.emplace(BlockId, std::move(Block));
     }
+
+    if (m_TargetSuccess > 0 && m_StopBlock == std::numeric_limits<size_t>::max())
+    {
+        CheckBuildTarget();
+    }
+}
+
+void
+RainbowTable::SeedEndpointEstimate(
+    const size_t Member
+)
+{
+    // A resumed build starts from the endpoints already written
+    std::ifstream table(MemberPath(Member), std::ios::binary);
+    table.seekg(sizeof(TableHeader));
+    const size_t offset = m_TableType == TypeUncompressed ? sizeof(rowindex_t) : 0;
+    std::vector<uint8_t> buffer(m_ChainWidth * m_Blocksize);
+    for (size_t chain = 0; chain < m_StartingChains; chain += m_Blocksize)
+    {
+        const size_t count = std::min(m_StartingChains - chain, m_Blocksize);
+        if (!table.read((char*)&buffer[0], count * m_ChainWidth))
+        {
+            std::cerr << "Unable to read existing chains" << std::endl;
+            return;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            m_EndpointEstimates[Member].Insert(Util::Hash64(&buffer[i * m_ChainWidth + offset], m_Max));
+        }
+    }
+}
+
+double
+RainbowTable::BuildSuccess(
+    const double Chains,
+    const std::vector<double>& Ratios
+) const
+{
+    // Members reduce independently so a word is only missed
+    // if every one of them misses it
+    double miss = 1.0;
+    for (const double ratio : Ratios)
+    {
+        miss *= 1.0 - Probability::SuccessProbability(
+            Probability::ColumnProbabilities(Chains * ratio, m_Length, m_BuildKeyspace),
+            std::vector<uint8_t>(m_Length, 1)
+        );
+    }
+    return 1.0 - miss;
+}
+
+void
+RainbowTable::CheckBuildTarget(
+    void
+)
+{
+    assert(dispatch::CurrentDispatcher() == dispatch::GetDispatcher("main").get());
+
+    // The model gives the unique endpoints that random chains would
+    // reach. A shortfall in those counted means chains merged more
+    // than expected, so the excess is treated as never built
+    const double chains = m_StartingChains + m_ChainsWritten;
+    const std::vector<double> columns = Probability::ColumnProbabilities(chains, m_Length, m_BuildKeyspace);
+    const double expected = m_BuildKeyspace * -std::expm1(-columns.back());
+    std::vector<double> ratios;
+    double counted = 0.0;
+    for (const HyperLogLog& estimate : m_EndpointEstimates)
+    {
+        ratios.push_back(expected > 0 ? std::min(estimate.Estimate() / expected, 1.0) : 1.0);
+        counted += estimate.Estimate();
+    }
+    m_BuildSuccess = BuildSuccess(chains, ratios);
+
+    std::string reason;
+    const double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_BuildStart).count() / 3600;
+    if (m_BuildSuccess >= m_TargetSuccess)
+    {
+        reason = "Target success reached";
+    }
+    // Wait a minute so the build rate has settled
+    else if (m_MinGain > 0 && hours >= 1.0 / 60)
+    {
+        const double perHour = m_ChainsWritten / hours;
+        const double gain = (BuildSuccess(chains + perHour, ratios) - m_BuildSuccess) * 100;
+        if (gain < m_MinGain)
+        {
+            std::stringstream message;
+            message << "Next hour would add " << gain << "% success, below " << m_MinGain << "%";
+            reason = message.str();
+        }
+    }
+
+    if (!reason.empty())
+    {
+        // Blocks already handed out are still written so
+        // the table has no gaps. Later blocks are never started
+        m_StopBlock = m_NextWriteBlock + m_Threads;
+        std::cerr << std::endl << reason << std::endl;
+        std::cerr << "Estimated success: " << m_BuildSuccess * 100 << "% (";
+        std::cerr << (size_t)counted << " unique endpoints of " << (size_t)(expected * m_Family) << " expected)" << std::endl;
+    }
 }
 
 bool
 RainbowTable::SetType(
     const std::string Type
 )
+{
+    SetType(ParseType(Type));
+    return m_TableType != TypeInvalid;
+}
+
+/* static */ const TableType
+RainbowTable::ParseType(
+    const std::string& Type
+)
 {
     if (Type == "compressed")
     {
-        SetType(TypeCompressed);
+        return TypeCompressed;
     }
     else if (Type == "uncompressed")
     {
-        SetType(TypeUncompressed);
+        return TypeUncompressed;
     }
-    else
+    else if (Type == "fingerprint")
     {
-        SetType(TypeInvalid);
-        return false;
+        return TypeFingerprint;
+    }
+    else if (Type == "delta")
+    {
+        return TypeDelta;
+    }
+    else if (Type == "eytzinger")
+    {
+        return TypeEytzinger;
+    }
+    else if (Type == "columnar")
+    {
+        return TypeColumnar;
+    }
+    return TypeInvalid;
+}
+
+/* static */ const std::string
+RainbowTable::ExtensionForType(
+    const TableType Type
+)
+{
+    switch (Type)
+    {
+    case TypeUncompressed:
+        return ".utbl";
+    case TypeFingerprint:
+        return ".ftbl";
+    case TypeDelta:
+        return ".dtbl";
+    case TypeEytzinger:
+        return ".etbl";
+    case TypeColumnar:
+        return ".ctbl";
+    default:
+        return ".tbl";
+    }
+}
+
+/* static */ const std::string
+RainbowTable::TypeToString(
+    const TableType Type
+)
+{
+    switch (Type)
+    {
+    case TypeUncompressed:
+        return "Uncompressed";
+    case TypeCompressed:
+        return "Compressed";
+    case TypeFingerprint:
+        return "Fingerprint";
+    case TypeDelta:
+        return "Delta";
+    case TypeEytzinger:
+        return "Eytzinger";
+    case TypeColumnar:
+        return "Columnar";
+    default:
+        return "Invalid";
     }
-    return true;
 }
 
 float
@@ -377,1154 +631,4683 @@ RainbowTable::GetCoverage(
     return percentage.get_d();
 }
 
-void
-RainbowTable::StoreTableHeader(
-    void
-) const
+bool
+RainbowTable::SetHugePages(
+    const std::string& Size
+)
 {
-    TableHeader hdr;
-    memset(&hdr, 0, sizeof(hdr));
-    hdr.magic = kMagic;
-    hdr.type = m_TableType;
-    hdr.algorithm = m_Algorithm;
-    hdr.min = m_Min;
-    hdr.max = m_Max;
-    hdr.length = m_Length;
-    hdr.charsetlen = m_Charset.size();
-    strncpy(hdr.charset, &m_Charset[0], sizeof(hdr.charset));
-
-    std::ofstream fs(m_Path, std::ios::out | std::ios::binary);
-    fs.write((const char*)&hdr, sizeof(hdr));
-    fs.close();
+    if (Size == "2M" || Size == "2m")
+    {
+        m_HugePageSize = 2 * 1024 * 1024;
+    }
+    else if (Size == "1G" || Size == "1g")
+    {
+        m_HugePageSize = 1024 * 1024 * 1024;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
 }
 
-/* static */ bool
-RainbowTable::GetTableHeader(
-    const std::filesystem::path& Path,
-    TableHeader* Header
+void
+RainbowTable::Prefault(
+    void
 )
 {
-    if (std::filesystem::file_size(Path) < sizeof(TableHeader))
+    // Each shard faults itself in, all at the same time
+    if (!m_Shards.empty())
     {
-        return false;
+        std::vector<std::thread> threads;
+        for (auto& shard : m_Shards)
+        {
+            threads.emplace_back([&]() { shard->Prefault(); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return;
     }
 
-    std::ifstream fs(Path, std::ios::binary);
-    if (!fs.is_open())
+    if (m_Remote != nullptr)
     {
-        return false;
+        return;
     }
 
-    fs.read((char*)Header, sizeof(TableHeader));
-    fs.close();
+    const auto start = std::chrono::steady_clock::now();
 
-    if (Header->magic != kMagic)
+    // Storage that is not mapped can only be asked to read ahead
+    if (m_MappedTable == nullptr)
     {
-        return false;
+        m_Storage->Readahead(0, m_MappedFileSize);
+    }
+    else
+    {
+        // Each thread faults in one contiguous slice of the table
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        const size_t pages = (m_MappedFileSize + pageSize - 1) / pageSize;
+        const size_t threads = m_DispatchPool == nullptr ? 1 : m_Threads;
+        std::atomic<uint64_t> checksum = 0;
+        RunCrackWorkers([&](const size_t ThreadId) {
+            const size_t first = pages * ThreadId / threads;
+            const size_t last = pages * (ThreadId + 1) / threads;
+            bool populated = false;
+#ifdef MADV_POPULATE_READ
+            // Lets the kernel fault in the whole slice in one call
+            populated = last > first && madvise(m_MappedTable + first * pageSize, std::min(last * pageSize, m_MappedFileSize) - first * pageSize, MADV_POPULATE_READ) == 0;
+#endif
+            // Otherwise touch a byte in every page. The sum keeps
+            // the reads from being optimised away
+            uint64_t sum = 0;
+            for (size_t page = first; page < last && !populated; page++)
+            {
+                sum += m_MappedTable[page * pageSize];
+            }
+            checksum += sum;
+            m_CrackingThreadsRunning--;
+        });
     }
-    return true;
-}
 
-/* static */ bool
-RainbowTable::IsTableFile(
-    const std::filesystem::path& Path
-)
-{
-    TableHeader hdr;
-    return GetTableHeader(Path, &hdr);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::string factor;
+    const double size = Util::SizeFactor(m_MappedFileSize, factor);
+    std::cerr << "Prefaulted " << std::fixed << std::setprecision(1) << size << (factor.empty() ? "B" : factor);
+    std::cerr << " in " << elapsed.count() << "ms using " << GetStorageStats() << std::endl;
 }
 
 bool
-RainbowTable::LoadTable(
+RainbowTable::Warm(
     void
 )
 {
-    TableHeader hdr;
-
-    size_t fileSize = std::filesystem::file_size(m_Path);
+    if (m_Threads == 0)
+    {
+        m_Threads = std::thread::hardware_concurrency();
+    }
 
-    if(fileSize < sizeof(TableHeader))
+    if (m_Shards.empty() && !MapTable(true, m_StorageType))
     {
-        std::cerr << "Not enough data in file" << std::endl;
+        std::cerr << "Error mapping the table" << std::endl;
         return false;
     }
 
-    if (!GetTableHeader(m_Path, &hdr))
+    if (m_Threads > 1)
     {
-        std::cerr << "Error reading table header" << std::endl;
-        return false;
+        m_DispatchPool = dispatch::CreateDispatchPool("pool", m_Threads);
     }
 
-    m_TableType = (TableType)hdr.type;
-    m_Algorithm = (HashAlgorithm)hdr.algorithm;
-    m_Min = hdr.min;
-    m_Max = hdr.max;
-    m_Length = hdr.length;
-    m_Charset = std::string(&hdr.charset[0], &hdr.charset[hdr.charsetlen]);
-    m_HashWidth = GetHashWidth(m_Algorithm);
-    m_ChainWidth = GetChainWidth();
-    m_Chains = (std::filesystem::file_size(m_Path) - sizeof(TableHeader)) / m_ChainWidth;
+    // Faulting the table in also fills the page cache, so
+    // later processes mapping the table start warm too
+    Prefault();
 
-    size_t dataSize = fileSize - sizeof(TableHeader);
-    if (dataSize % m_ChainWidth != 0)
+    if (m_DispatchPool != nullptr)
     {
-        std::cerr << "Invalid or currupt table file. Data not a multiple of chain width" << std::endl;
-        return false;
+        m_DispatchPool->Stop();
+        m_DispatchPool->Wait();
     }
-
     return true;
 }
 
-const size_t
-RainbowTable::GetCount(
-    void
-) const
-{
-    return (std::filesystem::file_size(m_Path) - sizeof(TableHeader)) / GetChainWidth();
-}
-
 bool
-RainbowTable::ValidateConfig(
+RainbowTable::Analyze(
     void
 )
 {
-    if (m_Path.empty())
+    if (m_TableType != TypeUncompressed || !m_Shards.empty())
     {
-        std::cerr << "No rainbow table file specified" << std::endl;
+        std::cerr << "Only sorted uncompressed tables can be analyzed" << std::endl;
         return false;
     }
 
-    if (TableExists())
+    if (m_Threads == 0)
     {
-        LoadTable();
-        m_PathLoaded = true;
+        m_Threads = std::thread::hardware_concurrency();
     }
 
-    if (m_Max == 0)
+    if (!MapTable(true, m_StorageType))
     {
-        std::cerr << "No max length specified" << std::endl;
+        std::cerr << "Error mapping the table" << std::endl;
         return false;
     }
 
-    if (m_Min == 0)
+    if (m_Threads > 1)
     {
-        std::cerr << "No min length specified" << std::endl;
-        return false;
+        m_DispatchPool = dispatch::CreateDispatchPool("pool", m_Threads);
     }
 
-#ifndef BIGINT
-    mpz_class upperbound = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset);
-    if (upperbound > std::numeric_limits<uint64_t>::max())
+    // Each thread counts the endpoints in its slice that differ
+    // from the one before. Chains sharing an endpoint have merged
+    const size_t threads = m_DispatchPool == nullptr ? 1 : m_Threads;
+    std::atomic<size_t> unique = 0;
+    std::atomic<size_t> unsorted = 0;
+    RunCrackWorkers([&](const size_t ThreadId) {
+        const size_t first = m_Chains * ThreadId / threads;
+        const size_t last = m_Chains * (ThreadId + 1) / threads;
+        size_t count = 0;
+        size_t descending = 0;
+        // Unmapped storage reads every record into the same buffer,
+        // so keep a copy of the previous endpoint
+        std::vector<uint8_t> previous(m_Max);
+        if (first > 0 && first < last)
+        {
+            memcpy(&previous[0], GetEndpointAt(first - 1), m_Max);
+        }
+        for (size_t i = first; i < last; i++)
+        {
+            const uint8_t* endpoint = GetEndpointAt(i);
+            const int cmp = i == 0 ? 1 : memcmp(endpoint, &previous[0], m_Max);
+            count += cmp != 0;
+            descending += cmp < 0;
+            memcpy(&previous[0], endpoint, m_Max);
+        }
+        unique += count;
+        unsorted += descending;
+        m_CrackingThreadsRunning--;
+    });
+
+    if (m_DispatchPool != nullptr)
     {
-        std::cerr << "Max length exceeds 64-bit integer limit" << std::endl;
-        std::cerr << "To compile with BIGINT support, recompile with -DBIGINT" << std::endl;
-        return false;
+        m_DispatchPool->Stop();
+        m_DispatchPool->Wait();
+        m_DispatchPool = nullptr;
     }
-#endif
 
-    if (m_Max > MAX_LENGTH)
+    if (unsorted > 0)
     {
-        std::cerr << "Max length is above supported maximum" << std::endl;
+        std::cerr << "Table is not sorted by endpoint" << std::endl;
         return false;
     }
 
-    if (m_Min > MAX_LENGTH)
+    if (!m_Indexed && m_Chains > 0)
     {
-        std::cerr << "Min length is above supported maximum" << std::endl;
-        return false;
+        IndexTable();
     }
 
-    if (m_Length == 0)
+    // Bucket sizes in powers of two. Large buckets mean long
+    // searches after the index, empty ones mean wasted entries
+    std::vector<size_t> histogram(65, 0);
+    size_t largest = 0;
+    for (size_t i = 0; i < LOOKUP_SIZE && m_Indexed; i++)
     {
-        std::cerr << "No chain length specified" << std::endl;
-        return false;
+        const size_t size = m_MappedTableLookupSize[i];
+        histogram[size == 0 ? 0 : 64 - __builtin_clzll(size)]++;
+        largest = std::max(largest, size);
     }
 
-    if (m_Algorithm == HashAlgorithmUndefined)
+    // The model assumes every chain is a random walk through the
+    // keyspace. Merges mean column i only holds m_i distinct words
+    mpz_class lowerbound = WordGenerator::WordLengthIndex(m_Min, m_Charset);
+    mpz_class upperbound = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset);
+    const double keyspace = mpz_class(upperbound - lowerbound).get_d();
+    const std::vector<double>& columns = GetColumnProbabilities();
+    const double expected = m_Length > 0 ? keyspace * -std::expm1(-columns.back()) : m_Chains;
+
+    // Chains that merged more than random walks would are treated
+    // as never built. Search for the chains the model would need to
+    // reach only the endpoints counted, as targeted builds do
+    double effective = m_Chains;
+    if (m_Length > 0 && unique < expected)
     {
-        std::cerr << "No algorithm specified" << std::endl;
-        return false;
+        double low = 0.0;
+        double high = m_Chains;
+        for (size_t i = 0; i < 64; i++)
+        {
+            const double middle = (low + high) / 2;
+            const double endpoints = keyspace * -std::expm1(-Probability::ColumnProbabilities(middle, m_Length, keyspace).back());
+            (endpoints < unique ? low : high) = middle;
+        }
+        effective = high;
     }
+    const double success = Probability::SuccessProbability(
+        Probability::ColumnProbabilities(effective, m_Length, keyspace),
+        std::vector<uint8_t>(m_Length, 1)
+    );
 
-    const size_t optimizedMax = GetOptimizedLength(m_Algorithm);
-    if (m_Max > optimizedMax)
+    // How much of the hashing for another 1% of chains would land
+    // on words the table does not already cover
+    const double extra = std::max(m_Chains / 100.0, 1.0);
+    const double more = Probability::SuccessProbability(
+        Probability::ColumnProbabilities(effective + extra, m_Length, keyspace),
+        std::vector<uint8_t>(m_Length, 1)
+    );
+    const double useful = (more - success) * keyspace / (extra * m_Length);
+
+    const size_t duplicates = m_Chains - unique;
+    std::cout << "Chains:      " << m_Chains << std::endl;
+    std::cout << "Unique:      " << unique << " endpoints (" << expected << " expected)" << std::endl;
+    std::cout << "Merge rate:  " << (m_Chains > 0 ? (double)duplicates / m_Chains * 100 : 0) << "% (" << duplicates << " duplicate endpoints)" << std::endl;
+    std::cout << "Buckets:     " << LOOKUP_SIZE - histogram[0] << " of " << LOOKUP_SIZE << " used, largest " << largest << std::endl;
+    for (size_t i = 1; i < histogram.size(); i++)
     {
-        std::cerr << "Max length cannot exceed optimized hash limit (" << optimizedMax << ")" << std::endl;
-        return false;
+        if (histogram[i] > 0)
+        {
+            const size_t low = (size_t)1 << (i - 1);
+            std::cout << "  " << std::setw(8) << low << "-" << std::left << std::setw(8) << low * 2 - 1 << std::right << histogram[i] << std::endl;
+        }
     }
+    std::cout << "KS Coverage: " << GetCoverage() << "% counting every chain in full" << std::endl;
+    std::cout << "Model:       " << GetSuccessProbability() * 100 << "% success from the chain count alone" << std::endl;
+    std::cout << "Effective:   " << success * keyspace << " distinct words (" << success * 100 << "% of the keyspace)" << std::endl;
+    std::cout << "Success:     " << success * 100 << "%" << std::endl;
+    std::cout << "Marginal:    " << useful * 100 << "% of the hashing for 1% more chains covers new words" << std::endl;
+    return true;
+}
 
-    if (m_Min > optimizedMax)
+double
+RainbowTable::BenchmarkSteps(
+    const bool Simd
+) const
+{
+    // Builds hash every lane at once, while cracking walks one
+    // chain at a time. Returns the seconds per step for one thread
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(250);
+    constexpr size_t kSteps = 64;
+    size_t steps = 0;
+    size_t column = 0;
+
+    if (Simd)
     {
-        std::cerr << "Min length cannot exceed optimized hash limit (" << optimizedMax << ")" << std::endl;
-        return false;
+        SimdHashBufferFixed<MAX_LENGTH> words;
+        std::array<uint8_t, MAX_HASH_SIZE * MAX_LANES> hashes;
+        const size_t lanes = SimdLanes();
+        for (size_t i = 0; i < lanes; i++)
+        {
+            memset(words[i], m_Charset[i % m_Charset.size()], m_Min);
+            words.SetLength(i, m_Min);
+        }
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            for (size_t n = 0; n < kSteps; n++, column++)
+            {
+                SimdHashOptimized(
+                    m_Algorithm,
+                    words.GetLengths(),
+                    words.ConstBuffers(),
+                    &hashes[0]
+                );
+                for (size_t h = 0; h < lanes; h++)
+                {
+                    const size_t length = reducer.Reduce((char*)words[h], m_Max, &hashes[h * m_HashWidth], column);
+                    words.SetLength(h, length);
+                }
+            }
+            steps += kSteps * lanes;
+        }
     }
+    else
+    {
+        char word[MAX_LENGTH];
+        uint8_t hash[MAX_BUFFER_SIZE];
+        size_t length = m_Min;
+        memset(word, m_Charset[0], length);
 
-    if (m_TableType == TypeInvalid)
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            for (size_t n = 0; n < kSteps; n++, column++)
+            {
+                DoHash((uint8_t*)word, length, hash);
+                length = reducer.Reduce(word, m_Max, hash, column);
+            }
+            steps += kSteps;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / steps;
+}
+
+bool
+RainbowTable::Plan(
+    const size_t SpaceBytes,
+    TablePlan* Recommended
+)
+{
+    if (m_Algorithm == HashAlgorithmUndefined || m_Charset.empty() || m_Min == 0 || m_Max == 0)
     {
-        std::cerr << "Invalid table type specified" << std::endl;
+        std::cerr << "Planning needs an algorithm, a charset and min and max lengths" << std::endl;
         return false;
     }
 
-    if (m_Blocksize == 0)
+    if (m_Min > m_Max || m_Max > GetOptimizedLength(m_Algorithm))
     {
-        std::cerr << "No block size specified" << std::endl;
+        std::cerr << "Invalid min or max length" << std::endl;
         return false;
     }
 
-    if (m_Blocksize % SimdLanes() != 0)
+    if (SpaceBytes == 0)
     {
-        std::cerr << "Block size must be a multiple of Simd width (" << SimdLanes() << ")" << std::endl;
+        std::cerr << "No space budget specified with --space-mb" << std::endl;
         return false;
     }
 
-    if (m_Charset.empty())
+    if (m_Threads == 0)
     {
-        std::cerr << "No or invalid charset specified" << std::endl;
+        m_Threads = std::thread::hardware_concurrency();
+    }
+
+    m_HashWidth = GetHashWidth(m_Algorithm);
+    const double target = m_TargetSuccess > 0 ? m_TargetSuccess : 0.95;
+    mpz_class lowerbound = WordGenerator::WordLengthIndex(m_Min, m_Charset);
+    mpz_class upperbound = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset);
+    const double keyspace = mpz_class(upperbound - lowerbound).get_d();
+    // Packed tables are converted from built ones so plan for those
+    const size_t width = IsPackedType(m_TableType) ? m_Max : GetChainWidth();
+
+    // Assumes the work scales with the threads
+    const double buildStep = BenchmarkSteps(true) / m_Threads;
+    const double crackStep = BenchmarkSteps(false) / m_Threads;
+
+    std::string factor;
+    double value = Util::NumFactor(1.0 / buildStep, factor);
+    std::cout << "Keyspace:    " << keyspace << " words" << std::endl;
+    std::cout << "Target:      " << target * 100 << "% success in " << SpaceBytes / (1024 * 1024) << "MB at " << width << " bytes per chain" << std::endl;
+    std::cout << "Benchmark:   " << std::fixed << std::setprecision(1) << value << factor << " steps/s building, ";
+    value = Util::NumFactor(1.0 / crackStep, factor);
+    std::cout << value << factor << " steps/s cracking (" << m_Threads << " threads)" << std::endl;
+
+    auto success = [&](const double Chains, const size_t Length, const size_t Tables) {
+        const double single = Probability::SuccessProbability(
+            Probability::ColumnProbabilities(Chains, Length, keyspace),
+            std::vector<uint8_t>(Length, 1)
+        );
+        return 1.0 - std::pow(1.0 - single, (double)Tables);
+    };
+
+    std::cout << "Tables  Length    Chains/table  Size        Success  Build       Crack/hash  False alarms" << std::endl;
+    constexpr size_t kMaxLength = 1 << 20;
+    double bestCrack = std::numeric_limits<double>::max();
+    TablePlan best = {};
+    for (const size_t tables : {1, 2, 3, 4, 6, 8})
+    {
+        // Filling the budget allows the shortest chains, which
+        // are the cheapest to both build and crack with. Every
+        // table also carries its own header
+        const double perTable = (double)SpaceBytes / tables - sizeof(TableHeader);
+        const double chains = std::min(std::floor(perTable / width), keyspace);
+        if (chains < 1)
+        {
+            continue;
+        }
+
+        size_t high = 1;
+        while (high < kMaxLength && success(chains, high, tables) < target)
+        {
+            high *= 2;
+        }
+        if (success(chains, high, tables) < target)
+        {
+            std::cout << std::left << std::setw(8) << tables << "target unreachable in " << kMaxLength << " columns" << std::right << std::endl;
+            continue;
+        }
+        size_t low = high / 2;
+        while (high - low > 1)
+        {
+            const size_t middle = (low + high) / 2;
+            (success(chains, middle, tables) < target ? low : high) = middle;
+        }
+        const size_t length = high;
+
+        // A false alarm is an endpoint match on a chain that does
+        // not hold the word, costing a walk from the chain start
+        const std::vector<double> columns = Probability::ColumnProbabilities(chains, length, keyspace);
+        const double endpoints = keyspace * -std::expm1(-columns.back());
+        const double falseAlarms = tables * length * endpoints / keyspace;
+        const double crackSteps = tables * (length * (length + 1.0) / 2) + falseAlarms * length / 2;
+        const double crackTime = crackSteps * crackStep;
+        const double buildTime = tables * chains * length * buildStep;
+        const double size = tables * (chains * width + sizeof(TableHeader));
+
+        std::cout << std::left << std::setw(8) << tables << std::setw(10) << length << std::setw(14) << (size_t)chains;
+        value = Util::SizeFactor(size, factor);
+        std::stringstream column;
+        column << std::fixed << std::setprecision(1) << value << factor;
+        std::cout << std::setw(12) << column.str();
+        column.str("");
+        column << success(chains, length, tables) * 100 << "%";
+        std::cout << std::setw(9) << column.str();
+        value = Util::TimeFactor(buildTime, factor);
+        column.str("");
+        column << value << factor;
+        std::cout << std::setw(12) << column.str();
+        value = Util::TimeFactor(crackTime, factor);
+        column.str("");
+        column << value << factor;
+        std::cout << std::setw(12) << column.str() << falseAlarms << std::right << std::endl;
+
+        if (crackTime < bestCrack)
+        {
+            bestCrack = crackTime;
+            best = {tables, length, (size_t)chains, (size_t)size, success(chains, length, tables)};
+        }
+    }
+
+    if (best.tables == 0)
+    {
+        std::cerr << "No plan reaches the target within the budget" << std::endl;
         return false;
     }
 
+    // Crack time is the worst case, for a hash the tables do not hold
+    std::cout << "Recommended: --length " << best.length << " --count " << best.chains;
+    if (best.tables > 1)
+    {
+        std::cout << " --family " << best.tables;
+    }
+    std::cout << std::endl;
+
+    if (Recommended != nullptr)
+    {
+        *Recommended = best;
+    }
     return true;
 }
 
-void
-RainbowTable::BuildThreadCompleted(
-    const size_t ThreadId
+const std::vector<double>&
+RainbowTable::GetColumnProbabilities(
+    void
 )
 {
-    m_ThreadsCompleted++;
-    if (m_ThreadsCompleted == m_Threads)
+    if (m_ColumnProbabilities.size() != m_Length)
     {
-        // Stop the pool
-        if (m_DispatchPool != nullptr)
-        {
-            m_DispatchPool->Stop();
-            m_DispatchPool->Wait();
-        }
-
-        // Stop the current (main) dispatcher
-        dispatch::CurrentDispatcher()->Stop();
+        mpz_class lowerbound = WordGenerator::WordLengthIndex(m_Min, m_Charset);
+        mpz_class upperbound = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset);
+        mpz_class keyspace = upperbound - lowerbound;
+        m_ColumnProbabilities = Probability::ColumnProbabilities(m_Chains, m_Length, keyspace.get_d());
     }
+    return m_ColumnProbabilities;
 }
 
-bool
-RainbowTable::UnmapTable(
+double
+RainbowTable::GetSuccessProbability(
     void
 )
 {
-    int result = 0;
-    if (m_MappedTable != nullptr)
+    return Probability::SuccessProbability(GetColumnProbabilities(), std::vector<uint8_t>(m_Length, 1));
+}
+
+double
+RainbowTable::GetBitsPerChain(
+    void
+) const
+{
+    if (m_Chains == 0)
     {
-        result = munmap(m_MappedTable, m_MappedTableSize);
-        m_MappedTable = nullptr;
-        m_MappedTableSize = 0;
-        if (result != 0)
-        {
-            std::cerr << "Unable to unmap table" << std::endl;
-        }
+        return 0.f;
     }
+    return (double)(std::filesystem::file_size(m_Path) - sizeof(TableHeader)) * 8 / m_Chains;
+}
 
-    if (m_MappedTableFd != nullptr)
+double
+RainbowTable::GetFalseAlarmRate(
+    void
+) const
+{
+    // The expected number of records which share a fingerprint
+    // with an endpoint that is not in the table
+    if (m_TableType != TypeFingerprint)
     {
-        fclose(m_MappedTableFd);
-        m_MappedTableFd = nullptr;
+        return 0.f;
     }
+    return (double)m_Chains / std::pow(2.0, m_FingerprintBits);
+}
 
-    return result == 0;
+/* static */ const std::filesystem::path
+RainbowTable::FamilyPath(
+    const std::filesystem::path& Path,
+    const size_t TableIndex
+)
+{
+    std::filesystem::path result = Path;
+    result.replace_filename(Path.stem().string() + ".t" + std::to_string(TableIndex) + Path.extension().string());
+    return result;
 }
 
 bool
-RainbowTable::MapTable(
-    const bool ReadOnly
+RainbowTable::OpenFamily(
+    void
 )
 {
-    // Check if it is already mapped
-    if (TableMapped())
+    m_WriteHandles.clear();
+    for (size_t member = 0; member < m_Family; member++)
     {
-        if (m_MappedReadOnly == ReadOnly)
+        // Members are built and resumed together so must stay in step
+        const std::filesystem::path path = MemberPath(member);
+        if (member > 0 && std::filesystem::exists(path))
         {
-            return true;
+            const TableHeader expected = MakeTableHeader(m_TableIndex + member);
+            TableHeader hdr;
+            if (!GetTableHeader(path, &hdr) || memcmp(&hdr, &expected, sizeof(hdr)) != 0)
+            {
+                std::cerr << path << " is not a member of this family" << std::endl;
+                return false;
+            }
+            if ((std::filesystem::file_size(path) - sizeof(TableHeader)) / m_ChainWidth != m_StartingChains)
+            {
+                std::cerr << path << " has a different number of chains" << std::endl;
+                return false;
+            }
+        }
+        else if (member > 0)
+        {
+            if (m_StartingChains != 0)
+            {
+                std::cerr << "Family member " << path << " is missing" << std::endl;
+                return false;
+            }
+            StoreTableHeader(path, m_TableIndex + member);
         }
-        // Unmap it to remap writable
-        if (!UnmapTable())
+
+        FILE* handle = fopen(path.c_str(), "a");
+        if (handle == nullptr)
         {
-            std::cerr << "Unmapping table failed" << std::endl;
+            std::cerr << "Unable to open table for writing" << std::endl;
             return false;
         }
+        m_WriteHandles.push_back(handle);
     }
+    return true;
+}
 
-    m_MappedFileSize = std::filesystem::file_size(m_Path);
-    m_MappedTableSize = m_MappedFileSize - sizeof(TableHeader);
-    if (ReadOnly)
-    {
-        m_MappedTableFd = fopen(m_Path.c_str(), "r");
-    }
-    else
-    {
-        m_MappedTableFd = fopen(m_Path.c_str(), "r+");
-    }
-    if (m_MappedTableFd == nullptr)
+const TableHeader
+RainbowTable::MakeTableHeader(
+    const size_t TableIndex
+) const
+{
+    TableHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = kMagic;
+    SetHeaderType(hdr, m_TableType);
+    hdr.algorithm = m_Algorithm;
+    hdr.min = m_Min;
+    hdr.max = m_Max;
+    hdr.length = m_Length;
+    hdr.tableindex = TableIndex;
+    hdr.charsetlen = m_Charset.size();
+    strncpy(hdr.charset, &m_Charset[0], sizeof(hdr.charset));
+    return hdr;
+}
+
+void
+RainbowTable::StoreTableHeader(
+    const std::filesystem::path& Path,
+    const size_t TableIndex
+) const
+{
+    const TableHeader hdr = MakeTableHeader(TableIndex);
+    std::ofstream fs(Path, std::ios::out | std::ios::binary);
+    fs.write((const char*)&hdr, sizeof(hdr));
+    fs.close();
+}
+
+/* static */ bool
+RainbowTable::GetTableHeader(
+    const std::filesystem::path& Path,
+    TableHeader* Header
+)
+{
+    if (std::filesystem::file_size(Path) < sizeof(TableHeader))
     {
-        std::cerr << "Unable to open a handle to the table file" << std::endl;
         return false;
     }
 
-    int flags = 0;
-    int prot = PROT_READ;
-    if (ReadOnly)
-    {
-        flags = MAP_PRIVATE;
-    }
-    else
+    std::ifstream fs(Path, std::ios::binary);
+    if (!fs.is_open())
     {
-        flags = MAP_SHARED;
-        prot |= PROT_WRITE;
+        return false;
     }
 
-    m_MappedTable = (uint8_t*)mmap(nullptr, m_MappedFileSize, prot, flags, fileno(m_MappedTableFd), 0);
-    if (m_MappedTable == MAP_FAILED)
+    fs.read((char*)Header, sizeof(TableHeader));
+    fs.close();
+
+    if (Header->magic != kMagic)
     {
-        std::cerr << "Unable to map table into memory: " << strerror(errno) << std::endl;
         return false;
     }
-    auto ret = madvise(m_MappedTable, m_MappedFileSize, MADV_RANDOM | MADV_WILLNEED);
-    if (ret != 0)
-    {
-        std::cerr << "Madvise not happy" << std::endl;
-    }
-
     return true;
 }
 
-const uint8_t*
-RainbowTable::GetRecordAt(
-    const size_t Index
-) const
-{
-    return m_MappedTable + sizeof(TableHeader) + (Index * GetChainWidth());
-}
-
-const uint8_t*
-RainbowTable::GetEndpointAt(
-    const size_t Index
-) const
+/* static */ bool
+RainbowTable::IsTableFile(
+    const std::filesystem::path& Path
+)
 {
-    // Get the pointer to the chain
-    const uint8_t* const entry = GetRecordAt(Index);
-    // Return the pointer to the endpoint
-    return m_TableType == TypeUncompressed ? entry + sizeof(rowindex_t) : entry;
+    TableHeader hdr;
+    return GetTableHeader(Path, &hdr);
 }
 
-void
-RainbowTable::IndexTable(
+bool
+RainbowTable::LoadTable(
     void
 )
 {
-    assert(TableMapped());
-    assert(GetCount() > 0);
+    TableHeader hdr;
 
-    // Zero the lengths
-    memset(m_MappedTableLookupSize, 0, sizeof(m_MappedTableLookupSize));
-    // Zero the pointers
-    memset(m_MappedTableLookup, 0, sizeof(m_MappedTableLookup));
+    // Split tables are loaded through their shards
+    if (IsManifest(m_Path))
+    {
+        return LoadManifest();
+    }
 
-# if 1
-    const size_t chainWidth = GetChainWidth();
-    const uint8_t* const base = GetEndpointAt(0);
+    size_t fileSize = std::filesystem::file_size(m_Path);
 
-    // Save the first endpoint
-    const uint16_t first = *(uint16_t*) base;
-    m_MappedTableLookup[first] = GetRecordAt(0);
+    if(fileSize < sizeof(TableHeader))
+    {
+        std::cerr << "Not enough data in file" << std::endl;
+        return false;
+    }
 
-    const size_t readahead = GetCount() > 65536 * 8 ? GetCount() / 65536 : 64;
+    if (!GetTableHeader(m_Path, &hdr))
+    {
+        std::cerr << "Error reading table header" << std::endl;
+        return false;
+    }
+
+    SetParametersFromHeader(hdr);
 
-    // First pass
-    for (size_t i = 0; i < GetCount(); i+= readahead)
+    size_t dataSize = fileSize - sizeof(TableHeader);
+
+    if (m_TableType >= TypeInvalid)
     {
-        const uint8_t* const next = GetEndpointAt(i);
-        const uint16_t index = *(uint16_t*)next;
-        if (m_MappedTableLookup[index] == nullptr ||
-            m_MappedTableLookup[index] > next)
-        {
-            m_MappedTableLookup[index] = GetRecordAt(i);
-        }
+        std::cerr << "Unknown table type" << std::endl;
+        return false;
     }
 
-    // Second pass -> N'th pass
-    // Loop over each known endpoint and check the previous entry
-    bool foundNewEntry;
-    do
+    // Packed tables describe their own layout
+    if (IsPackedType(m_TableType))
     {
-        foundNewEntry = false;
-        for (size_t i = 0; i < LOOKUP_SIZE; i++)
+        PackedHeader packed;
+        std::ifstream fs(m_Path, std::ios::binary);
+        fs.seekg(sizeof(TableHeader));
+        fs.read((char*)&packed, sizeof(packed));
+        if (!fs || dataSize < sizeof(PackedHeader))
+        {
+            std::cerr << "Invalid or corrupt table file. Missing packed header" << std::endl;
+            return false;
+        }
+
+        m_Chains = packed.count;
+        m_IndexBits = packed.indexbits;
+        m_ChainWidth = 0;
+
+        size_t packedSize = sizeof(PackedHeader) + BitPacking::kPadding;
+        if (m_TableType == TypeFingerprint)
+        {
+            m_FingerprintBits = packed.keybits;
+            packedSize += (m_Chains * (m_FingerprintBits + m_IndexBits) + 7) / 8;
+        }
+        else if (m_TableType == TypeEytzinger)
+        {
+            // Keys and records are both stored from slot one
+            packedSize = kAlignedDataOffset - sizeof(TableHeader) + (m_Chains + 1) * (sizeof(uint64_t) + GetEytzingerRecordWidth());
+        }
+        else if (m_TableType == TypeColumnar)
         {
-            const uint8_t* offset = m_MappedTableLookup[i] + sizeof(rowindex_t);
-            if (offset == nullptr)
+            // Endpoints are only needed when keys are a prefix
+            packedSize = kAlignedDataOffset - sizeof(TableHeader) + m_Chains * (sizeof(uint64_t) + sizeof(rowindex_t));
+            if (!m_EndpointKey.Exact())
             {
-                continue;
+                packedSize += m_Chains * m_Max;
             }
-
-            // Walk backwards until we find the previous
-            while (offset >= base)
+        }
+        else
+        {
+            m_DeltaBits = packed.keybits;
+            if (packed.blocksize == 0 && m_Chains > 0)
             {
-                const uint16_t next = *(uint16_t*)offset;
-                if (next == i)
-                {
-                    m_MappedTableLookup[i] = offset - sizeof(rowindex_t);
+                std::cerr << "Invalid or corrupt table file. Zero block size" << std::endl;
+                return false;
+            }
+            packedSize += (m_Chains + packed.blocksize - 1) / std::max((size_t)packed.blocksize, (size_t)1) * sizeof(DeltaBlock);
+        }
+
+        if (dataSize < packedSize)
+        {
+            std::cerr << "Invalid or corrupt table file. Not enough packed data" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    m_ChainWidth = GetChainWidth();
+    m_Chains = dataSize / m_ChainWidth;
+    if (dataSize % m_ChainWidth != 0)
+    {
+        std::cerr << "Invalid or currupt table file. Data not a multiple of chain width" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void
+RainbowTable::SetParametersFromHeader(
+    const TableHeader& Header
+)
+{
+    m_TableType = GetHeaderType(Header);
+    m_Algorithm = (HashAlgorithm)Header.algorithm;
+    m_Min = Header.min;
+    m_Max = Header.max;
+    m_Length = Header.length;
+    m_Charset = std::string(&Header.charset[0], &Header.charset[Header.charsetlen]);
+    m_TableIndex = Header.tableindex;
+    m_HashWidth = GetHashWidth(m_Algorithm);
+    m_EndpointKey = EndpointKey(m_Charset, m_Max);
+}
+
+const size_t
+RainbowTable::GetCount(
+    void
+) const
+{
+    if (IsPackedType(m_TableType) || !m_Shards.empty())
+    {
+        return m_Chains;
+    }
+    return (std::filesystem::file_size(m_Path) - sizeof(TableHeader)) / GetChainWidth();
+}
+
+bool
+RainbowTable::ValidateConfig(
+    void
+)
+{
+    if (m_Path.empty())
+    {
+        std::cerr << "No rainbow table file specified" << std::endl;
+        return false;
+    }
+
+    if (TableExists())
+    {
+        LoadTable();
+        m_PathLoaded = true;
+    }
+
+    if (m_Max == 0)
+    {
+        std::cerr << "No max length specified" << std::endl;
+        return false;
+    }
+
+    if (m_Min == 0)
+    {
+        std::cerr << "No min length specified" << std::endl;
+        return false;
+    }
+
+#ifndef BIGINT
+    mpz_class upperbound = WordGenerator::WordLengthIndex(m_Max + 1, m_Charset);
+    if (upperbound > std::numeric_limits<uint64_t>::max())
+    {
+        std::cerr << "Max length exceeds 64-bit integer limit" << std::endl;
+        std::cerr << "To compile with BIGINT support, recompile with -DBIGINT" << std::endl;
+        return false;
+    }
+#endif
+
+    if (m_Max > MAX_LENGTH)
+    {
+        std::cerr << "Max length is above supported maximum" << std::endl;
+        return false;
+    }
+
+    if (m_Min > MAX_LENGTH)
+    {
+        std::cerr << "Min length is above supported maximum" << std::endl;
+        return false;
+    }
+
+    if (m_Length == 0)
+    {
+        std::cerr << "No chain length specified" << std::endl;
+        return false;
+    }
+
+    // The header stores the length in 32 bits
+    if (m_Length > std::numeric_limits<uint32_t>::max())
+    {
+        std::cerr << "Chain length must be below 2^32" << std::endl;
+        return false;
+    }
+
+    if (m_Algorithm == HashAlgorithmUndefined)
+    {
+        std::cerr << "No algorithm specified" << std::endl;
+        return false;
+    }
+
+    const size_t optimizedMax = GetOptimizedLength(m_Algorithm);
+    if (m_Max > optimizedMax)
+    {
+        std::cerr << "Max length cannot exceed optimized hash limit (" << optimizedMax << ")" << std::endl;
+        return false;
+    }
+
+    if (m_Min > optimizedMax)
+    {
+        std::cerr << "Min length cannot exceed optimized hash limit (" << optimizedMax << ")" << std::endl;
+        return false;
+    }
+
+    if (m_TableType == TypeInvalid)
+    {
+        std::cerr << "Invalid table type specified" << std::endl;
+        return false;
+    }
+
+    if (IsPackedType(m_TableType))
+    {
+        std::cerr << GetType() << " tables can not be built directly. Convert a built table with decompress" << std::endl;
+        return false;
+    }
+
+    if (m_TableIndex + m_Family > std::numeric_limits<uint8_t>::max() + 1)
+    {
+        std::cerr << "Table indexes must be below 256" << std::endl;
+        return false;
+    }
+
+    if (m_Blocksize == 0)
+    {
+        std::cerr << "No block size specified" << std::endl;
+        return false;
+    }
+
+    if (m_Blocksize % SimdLanes() != 0)
+    {
+        std::cerr << "Block size must be a multiple of Simd width (" << SimdLanes() << ")" << std::endl;
+        return false;
+    }
+
+    if (m_Charset.empty())
+    {
+        std::cerr << "No or invalid charset specified" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void
+RainbowTable::BuildThreadCompleted(
+    const size_t ThreadId
+)
+{
+    m_ThreadsCompleted++;
+    if (m_ThreadsCompleted == m_Threads)
+    {
+        // Stop the pool
+        if (m_DispatchPool != nullptr)
+        {
+            m_DispatchPool->Stop();
+            m_DispatchPool->Wait();
+        }
+
+        // Stop the current (main) dispatcher
+        dispatch::CurrentDispatcher()->Stop();
+    }
+}
+
+bool
+RainbowTable::UnmapTable(
+    void
+)
+{
+    m_Storage.reset();
+    m_MappedTable = nullptr;
+    m_MappedFileSize = 0;
+    m_MappedTableSize = 0;
+
+    // The index is rebuilt for each mapping
+    ReleaseIndex();
+
+    return true;
+}
+
+bool
+RainbowTable::MapTable(
+    const bool ReadOnly,
+    const StorageType Storage
+)
+{
+    // Writing always goes through a shared mapping
+    const StorageType storage = ReadOnly ? Storage : StorageMmap;
+
+    // Check if it is already mapped
+    if (TableMapped())
+    {
+        if (m_MappedReadOnly == ReadOnly && m_Storage->Type() == storage)
+        {
+            return true;
+        }
+        // Unmap it to remap writable or with different storage
+        UnmapTable();
+    }
+
+    // Only flat tables can be searched without a mapping
+    if (storage == StoragePread && m_TableType != TypeCompressed && m_TableType != TypeUncompressed)
+    {
+        std::cerr << "Pread storage only supports compressed and uncompressed tables" << std::endl;
+        return false;
+    }
+
+    if (storage == StoragePread)
+    {
+        auto reader = std::make_unique<PreadStorage>();
+        reader->SetCacheSize(m_CacheSize);
+        m_Storage = std::move(reader);
+    }
+    else if (storage == StorageMemory)
+    {
+        auto memory = std::make_unique<MemoryStorage>();
+        memory->SetLocked(m_Mlock);
+        if (m_HugePageSize > 0)
+        {
+            memory->SetHugePageSize(m_HugePageSize);
+        }
+        m_Storage = std::move(memory);
+    }
+    else if (storage == StorageShared)
+    {
+        m_Storage = std::make_unique<SharedStorage>();
+    }
+    else
+    {
+        auto mapping = std::make_unique<MmapStorage>();
+        if (m_MmapAdvice.empty())
+        {
+            MmapStorage::ParseAdvice("random,willneed", m_MmapAdvice);
+        }
+        mapping->SetAdvice(m_MmapAdvice);
+        mapping->SetHugePages(m_HugePageSize > 0);
+        m_Storage = std::move(mapping);
+    }
+
+    if (!m_Storage->Open(m_Path, ReadOnly))
+    {
+        m_Storage.reset();
+        return false;
+    }
+
+    m_MappedTable = m_Storage->Data();
+    m_MappedFileSize = m_Storage->Size();
+    m_MappedTableSize = m_MappedFileSize - sizeof(TableHeader);
+    m_MappedReadOnly = ReadOnly;
+
+    return true;
+}
+
+const uint8_t*
+RainbowTable::GetRecordAt(
+    const size_t Index
+) const
+{
+    const size_t offset = sizeof(TableHeader) + (Index * GetChainWidth());
+    if (m_MappedTable != nullptr)
+    {
+        return m_MappedTable + offset;
+    }
+
+    // Unmapped storage reads into a per thread buffer which
+    // is only valid until the next read on the same thread
+    thread_local uint8_t record[sizeof(rowindex_t) + MAX_LENGTH];
+    return m_Storage->Read(offset, GetChainWidth(), &record[0]);
+}
+
+const uint8_t*
+RainbowTable::GetEndpointAt(
+    const size_t Index
+) const
+{
+    // Get the pointer to the chain
+    const uint8_t* const entry = GetRecordAt(Index);
+    // Return the pointer to the endpoint
+    return m_TableType == TypeUncompressed ? entry + sizeof(rowindex_t) : entry;
+}
+
+void
+RainbowTable::IndexTable(
+    void
+)
+{
+    assert(TableMapped());
+    assert(GetCount() > 0);
+
+    // Index into process memory unless a shared segment was provided
+    if (m_MappedTableLookup == nullptr)
+    {
+        m_LocalIndex.resize(LOOKUP_SIZE * 2);
+        m_MappedTableLookup = &m_LocalIndex[0];
+        m_MappedTableLookupSize = &m_LocalIndex[LOOKUP_SIZE];
+    }
+
+    // Zero the lengths
+    std::fill(m_MappedTableLookupSize, m_MappedTableLookupSize + LOOKUP_SIZE, 0);
+    // Mark every prefix as unseen
+    std::fill(m_MappedTableLookup, m_MappedTableLookup + LOOKUP_SIZE, kNoRecord);
+
+# if 1
+    // Save the first endpoint
+    const uint16_t first = *(uint16_t*)GetEndpointAt(0);
+    m_MappedTableLookup[first] = 0;
+
+    const size_t readahead = GetCount() > 65536 * 8 ? GetCount() / 65536 : 64;
+
+    // First pass. The final record is always sampled as
+    // buckets are only discovered by walking backwards
+    for (size_t i = 0; i < GetCount() + readahead; i += readahead)
+    {
+        const size_t record = std::min(i, GetCount() - 1);
+        const uint16_t index = *(uint16_t*)GetEndpointAt(record);
+        if (m_MappedTableLookup[index] == kNoRecord ||
+            m_MappedTableLookup[index] > record)
+        {
+            m_MappedTableLookup[index] = record;
+        }
+    }
+
+    // Second pass -> N'th pass
+    // Loop over each known endpoint and check the previous entry
+    bool foundNewEntry;
+    do
+    {
+        foundNewEntry = false;
+        for (size_t i = 0; i < LOOKUP_SIZE; i++)
+        {
+            if (m_MappedTableLookup[i] == kNoRecord)
+            {
+                continue;
+            }
+
+            // Walk backwards until we find the previous
+            for (size_t record = m_MappedTableLookup[i] + 1; record-- > 0;)
+            {
+                const uint16_t next = *(uint16_t*)GetEndpointAt(record);
+                if (next == i)
+                {
+                    m_MappedTableLookup[i] = record;
+                }
+                else
+                {
+                    if (m_MappedTableLookup[next] == kNoRecord)
+                    {
+                        m_MappedTableLookup[next] = record;
+                        foundNewEntry = true;
+                    }
+                    break;
+                }
+            }
+        }
+    } while(foundNewEntry);
+
+    // Calculate the counts. Each bucket runs until
+    // the start of the next one in the table
+    std::vector<std::pair<size_t, size_t>> buckets;
+    for (size_t i = 0; i < LOOKUP_SIZE; i++)
+    {
+        if (m_MappedTableLookup[i] != kNoRecord)
+        {
+            buckets.push_back({m_MappedTableLookup[i], i});
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        const size_t next = i + 1 < buckets.size() ? buckets[i + 1].first : GetCount();
+        m_MappedTableLookupSize[buckets[i].second] = next - buckets[i].first;
+    }
+
+    // Linear version
+#else
+    uint16_t last = *(uint16_t*)GetEndpointAt(0);
+    m_MappedTableLookup[last] = 0;
+    size_t count = 1;
+    for (size_t i = 1; i < GetCount(); i++)
+    {
+        const uint16_t index = *(uint16_t*)GetEndpointAt(i);
+        // New id, we need to walk back
+        if (index != last)
+        {
+            m_MappedTableLookupSize[last] = count;
+            m_MappedTableLookup[index] = i;
+            count = 1;
+        }
+        else
+        {
+            count++;
+        }
+        last = index;
+    }
+    m_MappedTableLookupSize[last] = count;
+#endif
+
+    m_Indexed = true;
+}
+
+bool
+RainbowTable::ShareIndex(
+    void
+)
+{
+    // The index only holds record numbers so it means the
+    // same thing in every process regardless of storage
+    auto segment = std::make_unique<SharedSegment>();
+    bool created;
+    if (!segment->Open(SharedSegment::NameForFile(m_Path, "idx"), LOOKUP_SIZE * 2 * sizeof(size_t), created))
+    {
+        return false;
+    }
+
+    m_MappedTableLookup = (size_t*)segment->Data();
+    m_MappedTableLookupSize = m_MappedTableLookup + LOOKUP_SIZE;
+    if (created)
+    {
+        std::cerr << "Indexing table into " << segment->Name() << "..";
+        IndexTable();
+        segment->Publish();
+        std::cerr << " done." << std::endl;
+    }
+    else
+    {
+        std::cerr << "Attached shared index " << segment->Name() << std::endl;
+    }
+
+    m_SharedIndex = std::move(segment);
+    m_Indexed = true;
+    return true;
+}
+
+size_t
+RainbowTable::Unshare(
+    void
+) const
+{
+    // Each shard shares its own table and index
+    std::vector<std::filesystem::path> paths;
+    for (const TableShard& shard : m_ShardRanges)
+    {
+        paths.push_back(shard.path);
+    }
+    if (paths.empty())
+    {
+        paths.push_back(m_Path);
+    }
+
+    size_t removed = 0;
+    for (const auto& path : paths)
+    {
+        // Served shards live in other processes
+        if (!std::filesystem::exists(path))
+        {
+            continue;
+        }
+        for (const std::string suffix : {"idx", "tbl"})
+        {
+            const std::string name = SharedSegment::NameForFile(path, suffix);
+            if (SharedSegment::Remove(name))
+            {
+                std::cerr << "Removed shared segment " << name << " for " << path << std::endl;
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+void
+RainbowTable::ReleaseIndex(
+    void
+)
+{
+    m_Indexed = false;
+    m_MappedTableLookup = nullptr;
+    m_MappedTableLookupSize = nullptr;
+    m_SharedIndex.reset();
+    m_LocalIndex.clear();
+}
+
+/* static */
+const std::string
+RainbowTable::DoHashHex(
+    const uint8_t* Data,
+    const size_t Length,
+    const HashAlgorithm Algorithm
+)
+{
+    uint8_t buffer[MAX_BUFFER_SIZE];
+    DoHash(Data, Length, buffer, Algorithm);
+    return Util::ToHex(buffer, GetHashWidth(Algorithm));
+}
+
+const size_t
+RainbowTable::FindEndpoint(
+    const char* Endpoint,
+    const size_t Length
+) const
+{
+    // We need a null-padded buffer to compare against
+    char comparitor[MAX_LENGTH] = {0};
+    memcpy(&comparitor[0], Endpoint, Length);
+
+    if (!m_Shards.empty())
+    {
+        return m_Shards[ShardFor(&comparitor[0])]->FindEndpoint(Endpoint, Length);
+    }
+
+    if (m_Remote != nullptr)
+    {
+        std::vector<size_t> results;
+        return m_Remote->Find({std::string(&comparitor[0], m_Max)}, m_Max, results) ? results[0] : (size_t)-1;
+    }
+
+    if (!MayContainEndpoint(&comparitor[0]))
+    {
+        return (size_t)-1;
+    }
+
+    // Uncompressed tables are just flat files
+    // of endpoints, each of m_Max width. They are
+    // unsorted so we need to do a Linear search
+    if (m_TableType == TypeCompressed)
+    {
+        for (size_t c = 0; c < m_Chains; c++)
+        {
+            if (memcmp(GetEndpointAt(c), &comparitor[0], m_Max) == 0)
+            {
+                return c;
+            }
+        }
+    }
+    // Delta tables are decoded a block at a time
+    else if (m_TableType == TypeDelta)
+    {
+        return FindDelta(Endpoint, Length);
+    }
+    else if (m_TableType == TypeEytzinger)
+    {
+        return FindEytzinger(&comparitor[0]);
+    }
+    else if (m_TableType == TypeColumnar)
+    {
+        return FindColumnar(&comparitor[0]);
+    }
+    // Fingerprints are lossy so a single index can not be
+    // trusted, their lookups go through FindCandidates
+    else if (m_TableType == TypeFingerprint)
+    {
+        return (size_t)-1;
+    }
+    // Uncompressed files are flat binary files of an
+    // unsigned integer index, followed by the text
+    // endpoint of m_Max width. They are sortd by endpoint
+    // so we can do a binary search
+    else
+    {
+        // Lookup this endpoint's first record and count
+        uint16_t index = *(uint16_t*)&comparitor[0];
+        const size_t base = m_Indexed ? m_MappedTableLookup[index] : 0;
+        const size_t count = m_Indexed ? m_MappedTableLookupSize[index] : m_Chains;
+
+        // Endpoint not found in lookup table
+        if (count == 0)
+        {
+            return (size_t)-1;
+        }
+
+        // Perform the search over the half open range of records
+        size_t low = base;
+        size_t high = base + count;
+        while (low < high)
+        {
+            const size_t mid = low + (high - low) / 2;
+            const uint8_t* const record = GetRecordAt(mid);
+            int cmp = memcmp(record + sizeof(rowindex_t), &comparitor[0], m_Max);
+            if (cmp == 0)
+            {
+                return (size_t)*(rowindex_t*)record;
+            }
+            else if (cmp < 0)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+    }
+    return (size_t)-1;
+}
+
+// Every chain that may end in the endpoint. Fingerprint tables
+// return each record sharing the fingerprint, which must all be
+// validated, and the other types at most the one exact match
+std::vector<size_t>
+RainbowTable::FindCandidates(
+    const char* Endpoint,
+    const size_t Length
+) const
+{
+    std::vector<size_t> candidates;
+    if (m_TableType == TypeFingerprint && m_Shards.empty() && m_Remote == nullptr)
+    {
+        const uint64_t fingerprint = GetFingerprint(Endpoint, Length);
+        for (size_t record = FindFingerprint(fingerprint);
+            record < m_Chains && GetFingerprintAt(record) == fingerprint;
+            record++)
+        {
+            candidates.push_back(GetFingerprintIndexAt(record));
+        }
+        return candidates;
+    }
+
+    const size_t index = FindEndpoint(Endpoint, Length);
+    if (index != (size_t)-1)
+    {
+        candidates.push_back(index);
+    }
+    return candidates;
+}
+
+// Asks the kernel to start reading the part of the table that
+// a later FindEndpoint for this endpoint will search
+void
+RainbowTable::ReadaheadEndpoint(
+    const char* Endpoint
+) const
+{
+    if (!m_Shards.empty())
+    {
+        m_Shards[ShardFor(Endpoint)]->ReadaheadEndpoint(Endpoint);
+        return;
+    }
+
+    if (m_Remote != nullptr)
+    {
+        return;
+    }
+
+    size_t first = 0;
+    size_t last = 0;
+    if (m_TableType == TypeUncompressed && m_Indexed)
+    {
+        const uint16_t index = *(uint16_t*)Endpoint;
+        first = sizeof(TableHeader) + m_MappedTableLookup[index] * GetChainWidth();
+        last = first + m_MappedTableLookupSize[index] * GetChainWidth();
+    }
+    else if (m_TableType == TypeColumnar && m_LearnedIndex.Trained())
+    {
+        const auto [low, high] = m_LearnedIndex.Range(m_EndpointKey.Key((uint8_t*)Endpoint));
+        first = kAlignedDataOffset + low * sizeof(uint64_t);
+        last = kAlignedDataOffset + high * sizeof(uint64_t);
+    }
+
+    if (first != last)
+    {
+        m_Storage->Readahead(first, last - first);
+    }
+}
+
+// Checks a chain assuming the given iteration
+const size_t
+RainbowTable::ComputeEndpoint(
+    const HybridReducer& Reducer,
+    const uint8_t* Target,
+    const size_t Iteration,
+    char* Endpoint
+) const
+{
+    uint8_t hash[MAX_BUFFER_SIZE];
+    size_t  length;
+
+    memcpy(&hash[0], Target, m_HashWidth);
+
+    for (size_t j = Iteration; j < m_Length - 1; j++)
+    {
+        length = Reducer.Reduce(&Endpoint[0], m_Max, &hash[0], j);
+        DoHash((uint8_t*)&Endpoint[0], length, &hash[0]);
+    }
+
+    // Final reduction, null padded to the endpoint width
+    length = Reducer.Reduce(&Endpoint[0], m_Max, &hash[0], m_Length - 1);
+    memset(&Endpoint[length], 0, m_Max - length);
+    return length;
+}
+
+std::optional<std::string>
+RainbowTable::CheckIteration(
+    const HybridReducer& Reducer,
+    const std::vector<uint8_t>& Target,
+    const size_t Iteration
+) const
+{
+    char reduced[MAX_LENGTH];
+    const size_t length = ComputeEndpoint(Reducer, &Target[0], Iteration, &reduced[0]);
+
+    // Check end, if it matches, we can perform one full chain to see if we find it
+    for (const size_t index : FindCandidates(&reduced[0], length))
+    {
+        auto result = ValidateChain(index, &Target[0]);
+        if (result.has_value())
+        {
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+void
+RainbowTable::CrackOneWorker(
+    const size_t ThreadId,
+    const std::vector<uint8_t> Target
+)
+{
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+
+    for (ssize_t i = m_Length - 1 - ThreadId; i >= 0 && !m_Cracked; i -= m_Threads)
+    {
+        if (m_BudgetMs > 0 && std::chrono::steady_clock::now() >= m_Deadline)
+        {
+            break;
+        }
+        auto result = CheckIteration(reducer, Target, i);
+        m_ColumnSearched[i] = 1;
+        bool cracked = m_Cracked;
+        if (result.has_value() && !cracked && m_Cracked.compare_exchange_strong(cracked, true))
+        {
+            m_Cracked = true;
+            m_LastCracked = std::make_tuple(Util::ToHex(&Target[0], Target.size()), result.value());
+            m_CrackedResults.push_back(m_LastCracked);
+        }
+    }
+
+    m_CrackingThreadsRunning--;
+}
+
+std::optional<std::string>
+RainbowTable::CrackOne(
+    const std::string& Hash
+)
+{
+    if (Hash.size() != m_HashWidth * 2)
+    {
+        std::cerr << "Invalid length of provided hash: " << Hash.size() << " != " << m_HashWidth * 2 << std::endl;
+        std::cerr << "Hash: '" << Hash << "'" << std::endl;
+        return std::nullopt;
+    }
+
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+    auto target = Util::ParseHex(Hash);
+    std::optional<std::string> result;
+
+    // Columns are searched cheapest first so stopping at the
+    // deadline leaves the most likely columns covered
+    m_Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_BudgetMs);
+    m_ColumnSearched.assign(m_Length, 0);
+    m_BudgetExceeded = false;
+
+    // Perform linear check
+    if (m_Threads == 1)
+    {
+        for (ssize_t i = m_Length - 1; i >= 0; i--)
+        {
+            if (m_BudgetMs > 0 && std::chrono::steady_clock::now() >= m_Deadline)
+            {
+                break;
+            }
+            result = CheckIteration(reducer, target, i);
+            m_ColumnSearched[i] = 1;
+            if (result.has_value())
+            {
+                m_LastCracked = std::make_tuple(Util::ToHex(&target[0], target.size()), result.value());
+                m_CrackedResults.push_back(m_LastCracked);
+                break;
+            }
+        }
+    }
+    else
+    {
+        m_ThreadsCompleted = m_Threads;
+
+        // The running count is set before the work is posted, as
+        // workers that find the word early can finish before a
+        // wait for them to start would ever see them running
+        RunCrackWorkers([&](const size_t ThreadId) {
+            CrackOneWorker(ThreadId, target);
+        });
+
+        // Check if we found the result
+        if (m_Cracked)
+        {
+            result = std::get<1>(m_LastCracked);
+        }
+    }
+
+    // Report how much of the table was covered so the
+    // caller can decide whether to escalate
+    if (!result.has_value() && m_BudgetMs > 0)
+    {
+        const size_t searched = std::count(m_ColumnSearched.begin(), m_ColumnSearched.end(), 1);
+        m_LastProbability = Probability::SuccessProbability(GetColumnProbabilities(), m_ColumnSearched);
+        m_BudgetExceeded = searched < m_Length;
+        if (m_BudgetExceeded)
+        {
+            std::cerr << Hash << ": not found within budget, searched " << searched << " of " << m_Length;
+            std::cerr << " columns (" << m_LastProbability * 100 << "% of " << GetSuccessProbability() * 100 << "% success probability)" << std::endl;
+        }
+    }
+
+    return result;
+}
+
+void
+RainbowTable::BuildFilter(
+    void
+)
+{
+    // Keys are hashed so that the filter works for any table
+    // with directly addressable endpoints
+    m_Filter.Init(m_Chains, m_FilterBits);
+    if (m_HugePageSize > 0)
+    {
+        TableStorage::AdviseHugePages(m_Filter.Data(), m_Filter.SizeBytes());
+    }
+    if (m_TableType == TypeCompressed || m_TableType == TypeUncompressed)
+    {
+        for (size_t i = 0; i < m_Chains; i++)
+        {
+            const uint64_t key = m_EndpointKey.Key(GetEndpointAt(i));
+            m_Filter.Insert(Util::Hash64((uint8_t*)&key, sizeof(key)));
+        }
+    }
+    else if (m_TableType == TypeEytzinger)
+    {
+        for (size_t i = 1; i <= m_Chains; i++)
+        {
+            m_Filter.Insert(Util::Hash64((uint8_t*)&GetEytzingerKeys()[i], sizeof(uint64_t)));
+        }
+    }
+    else if (m_TableType == TypeColumnar)
+    {
+        for (size_t i = 0; i < m_Chains; i++)
+        {
+            m_Filter.Insert(Util::Hash64((uint8_t*)&GetColumnarKeys()[i], sizeof(uint64_t)));
+        }
+    }
+    else
+    {
+        std::cerr << "Filters are not supported on " << GetType() << " tables" << std::endl;
+        m_Filter.Clear();
+        return;
+    }
+
+    std::string factor;
+    const double size = Util::SizeFactor(m_Filter.SizeBytes(), factor);
+    std::cerr << "Built " << std::fixed << std::setprecision(1) << size << (factor.empty() ? "B" : factor) << " endpoint filter" << std::endl;
+}
+
+bool
+RainbowTable::MayContainEndpoint(
+    const char* Endpoint
+) const
+{
+    if (!m_Filter.Enabled())
+    {
+        return true;
+    }
+    const uint64_t key = m_EndpointKey.Key((uint8_t*)Endpoint);
+    return m_Filter.Contains(Util::Hash64((uint8_t*)&key, sizeof(key)));
+}
+
+std::vector<size_t>
+RainbowTable::FindEndpoints(
+    const std::vector<std::string>& Endpoints
+) const
+{
+    std::vector<size_t> results(Endpoints.size(), (size_t)-1);
+
+    // Each shard searches its own endpoints as one batch
+    if (!m_Shards.empty())
+    {
+        std::vector<std::vector<std::string>> batches(m_Shards.size());
+        std::vector<std::vector<size_t>> positions(m_Shards.size());
+        for (size_t i = 0; i < Endpoints.size(); i++)
+        {
+            char comparitor[MAX_LENGTH] = {0};
+            memcpy(&comparitor[0], Endpoints[i].c_str(), std::min(Endpoints[i].size(), m_Max));
+            const size_t shard = ShardFor(&comparitor[0]);
+            batches[shard].push_back(Endpoints[i]);
+            positions[shard].push_back(i);
+        }
+        for (size_t shard = 0; shard < m_Shards.size(); shard++)
+        {
+            const std::vector<size_t> found = m_Shards[shard]->FindEndpoints(batches[shard]);
+            for (size_t i = 0; i < found.size(); i++)
+            {
+                results[positions[shard][i]] = found[i];
+            }
+        }
+        return results;
+    }
+
+    if (m_Remote != nullptr)
+    {
+        m_Remote->Find(Endpoints, m_Max, results);
+        return results;
+    }
+
+    // Fingerprint tables have no single match per endpoint
+    // and are searched with FindCandidates instead
+    if (m_TableType == TypeFingerprint)
+    {
+        return results;
+    }
+
+    // Only mapped uncompressed tables have an interleaved
+    // search, the others are looked up one at a time
+    if (m_TableType != TypeUncompressed || m_MappedTable == nullptr)
+    {
+        for (size_t i = 0; i < Endpoints.size(); i++)
+        {
+            results[i] = FindEndpoint(Endpoints[i].c_str(), Endpoints[i].size());
+        }
+        return results;
+    }
+
+    const size_t chainWidth = GetChainWidth();
+    for (size_t group = 0; group < Endpoints.size(); group += kLookupGroupSize)
+    {
+        const size_t count = std::min(kLookupGroupSize, Endpoints.size() - group);
+        char comparitors[kLookupGroupSize][MAX_LENGTH] = {};
+        const uint8_t* low[kLookupGroupSize];
+        size_t length[kLookupGroupSize];
+
+        // Find the range of records to search for each endpoint
+        for (size_t i = 0; i < count; i++)
+        {
+            const std::string& endpoint = Endpoints[group + i];
+            memcpy(&comparitors[i][0], endpoint.c_str(), std::min(endpoint.size(), m_Max));
+            length[i] = 0;
+            if (!MayContainEndpoint(&comparitors[i][0]))
+            {
+                continue;
+            }
+
+            const uint16_t index = *(uint16_t*)&comparitors[i][0];
+            length[i] = m_Indexed ? m_MappedTableLookupSize[index] : m_Chains;
+            if (length[i] > 0)
+            {
+                low[i] = GetRecordAt(m_Indexed ? m_MappedTableLookup[index] : 0);
+                __builtin_prefetch(low[i] + (length[i] / 2) * chainWidth);
+            }
+        }
+
+        // Step each search once per pass. The next probe is prefetched
+        // straight away and is not needed until every other search in
+        // the group has taken its step
+        bool searching = true;
+        while (searching)
+        {
+            searching = false;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (length[i] <= 1)
+                {
+                    continue;
                 }
-                else
+                const size_t half = length[i] / 2;
+                const uint8_t* const mid = low[i] + half * chainWidth;
+                if (memcmp(mid + sizeof(rowindex_t), &comparitors[i][0], m_Max) <= 0)
                 {
-                    if (m_MappedTableLookup[next] == nullptr)
-                    {
-                        m_MappedTableLookup[next] = offset - sizeof(rowindex_t);
-                        foundNewEntry = true;
-                    }
-                    break;
+                    low[i] = mid;
                 }
-                offset -= chainWidth;
+                length[i] -= half;
+                __builtin_prefetch(low[i] + (length[i] / 2) * chainWidth);
+                searching |= length[i] > 1;
+            }
+        }
+
+        // Each search is left on the last record not greater than its endpoint
+        for (size_t i = 0; i < count; i++)
+        {
+            if (length[i] == 1 && memcmp(low[i] + sizeof(rowindex_t), &comparitors[i][0], m_Max) == 0)
+            {
+                results[group + i] = *(rowindex_t*)low[i];
+            }
+        }
+    }
+    return results;
+}
+
+bool
+RainbowTable::PrepareLookup(
+    void
+)
+{
+    if (!m_Shards.empty())
+    {
+        return PrepareShards();
+    }
+
+    // The serving process prepares its own table
+    if (m_Remote != nullptr)
+    {
+        return true;
+    }
+
+    // Map or load the table with the selected storage
+    if (!MapTable(true, m_StorageType))
+    {
+        std::cerr << "Error mapping the table" << std::endl;
+        return false;
+    }
+
+    // Index the table for multiple lookups
+    if (!m_IndexDisable && !m_Indexed && m_TableType == TypeUncompressed &&
+        !(m_ShareIndex && ShareIndex()))
+    {
+        std::cerr << "Indexing table..";
+        IndexTable();
+        std::cerr << " done." << std::endl;
+    }
+
+    // The filter is kept resident so most misses never touch the table
+    if (m_FilterBits > 0 && !m_Filter.Enabled())
+    {
+        BuildFilter();
+    }
+
+    // The learned index is kept next to the table
+    if (m_LearnedSearch && m_TableType == TypeColumnar && !m_LearnedIndex.Trained())
+    {
+        std::filesystem::path sidecar = m_Path;
+        sidecar += ".lidx";
+        if (!m_LearnedIndex.Load(sidecar, GetColumnarKeys(), m_Chains))
+        {
+            std::cerr << "Training learned index..";
+            m_LearnedIndex.Train(GetColumnarKeys(), m_Chains);
+            std::cerr << " done (" << m_LearnedIndex.Segments() << " segments)." << std::endl;
+            if (!m_LearnedIndex.Save(sidecar))
+            {
+                std::cerr << "Unable to save learned index to " << sidecar << std::endl;
+            }
+        }
+    }
+    else if (m_LearnedSearch && m_TableType != TypeColumnar)
+    {
+        std::cerr << "Learned index is only supported on columnar tables" << std::endl;
+    }
+
+    return true;
+}
+
+std::vector<std::tuple<std::string, std::string>>
+RainbowTable::Crack(
+    std::string& Target
+)
+{
+    // Both read the records of the whole table in order
+    if (!m_Shards.empty() && (m_TableScan || m_MergeJoin))
+    {
+        std::cerr << "Table scan and merge join are not supported on split tables" << std::endl;
+        return {};
+    }
+
+    if (!PrepareLookup())
+    {
+        return {};
+    }
+
+    // Check the argument
+    if (!Util::IsHex(Target) && !std::filesystem::exists(Target))
+    {
+        std::cerr << "Invalid target hash or file" << std::endl;
+        return {};
+    }
+
+    m_Operation = "Cracking";
+
+    if (m_Threads == 0)
+    {
+        m_Threads = std::thread::hardware_concurrency();
+    }
+
+    // Create the dispatch pool
+    if (m_Threads > 1)
+    {
+        m_DispatchPool = dispatch::CreateDispatchPool("pool", m_Threads);
+    }
+
+    // Start at steady state lookup speed
+    if (m_Prefault)
+    {
+        Prefault();
+    }
+
+    // Short words are cheaper to brute force than to look up so
+    // optionally find those first and skip them in the table
+    bool remaining = true;
+    if (m_BruteForce)
+    {
+        remaining = CrackBruteForce(Target);
+    }
+
+    if (!remaining)
+    {
+        std::cerr << "All targets found by brute force" << std::endl;
+    }
+    // Shards served by other processes are asked in batches
+    else if (m_Distributed)
+    {
+        CrackDistributed(Target);
+    }
+    // Whole target lists can be cracked in a single pass over the table
+    else if (m_TableScan)
+    {
+        CrackTableScan(Target);
+    }
+    else if (m_MergeJoin)
+    {
+        CrackMergeJoin(Target);
+    }
+    else if (m_Scheduled)
+    {
+        CrackScheduled(Target);
+    }
+    else if (m_Pipelined)
+    {
+        CrackPipelined(Target);
+    }
+    // Figure out if this is a single hash
+    else if (Util::IsHex(Target))
+    {
+        auto result = CrackOne(Target);
+        if (result)
+        {
+            std::cout << Target << m_Separator << result.value() << std::endl;
+        }
+    }
+    // Check if it is a file
+    else if (std::filesystem::exists(Target))
+    {
+        // Open the input file handle
+        m_HashFileStream = std::ifstream(Target);
+
+        std::string line;
+        while (std::getline(m_HashFileStream, line))
+        {
+            if (IsSolved(line))
+            {
+                continue;
+            }
+            m_ThreadsCompleted = 0;
+            m_Cracked = false;
+            auto result = CrackOne(line);
+            if (result.has_value())
+            {
+                std::cout << line << m_Separator << result.value() << std::endl;
+            }
+        }
+    }
+
+    // Stop the pool
+    if (m_DispatchPool != nullptr)
+    {
+        m_DispatchPool->Stop();
+        m_DispatchPool->Wait();
+    }
+
+    std::cerr << "Storage: " << GetStorageStats() << std::endl;
+
+    if (m_Family > 1)
+    {
+        CrackFamily(Target);
+    }
+
+    return std::move(m_CrackedResults);
+}
+
+// Hashes are given in either case and results are lower case hex
+// so solved hashes are kept in lower case
+void
+RainbowTable::MarkSolved(
+    const std::string& Hash
+)
+{
+    m_Solved.insert(Util::ToLower(Hash));
+}
+
+const bool
+RainbowTable::IsSolved(
+    const std::string& Hash
+) const
+{
+    return m_Solved.count(Util::ToLower(Hash)) > 0;
+}
+
+void
+RainbowTable::CrackFamily(
+    std::string& Target
+)
+{
+    // Every member reduces differently so each computes its own
+    // endpoints. Hashes found by earlier members are skipped
+    for (const auto& [hash, word] : m_CrackedResults)
+    {
+        MarkSolved(hash);
+    }
+
+    for (size_t member = 1; member < m_Family; member++)
+    {
+        if (Util::IsHex(Target) && !m_CrackedResults.empty())
+        {
+            return;
+        }
+
+        RainbowTable table;
+        table.SetPath(MemberPath(member));
+        CopyLookupSettings(table);
+        table.m_Solved = m_Solved;
+
+        if (!table.ValidTable() || !table.LoadTable())
+        {
+            std::cerr << "Unable to load family member " << table.m_Path << std::endl;
+            return;
+        }
+        if (table.m_TableIndex != m_TableIndex + member || table.m_Algorithm != m_Algorithm)
+        {
+            std::cerr << table.m_Path << " is not a member of this family" << std::endl;
+            return;
+        }
+
+        for (auto& result : table.Crack(Target))
+        {
+            MarkSolved(std::get<0>(result));
+            m_CrackedResults.push_back(std::move(result));
+        }
+    }
+}
+
+// Tables opened on behalf of this one, family members and
+// shards, are searched with the same options
+void
+RainbowTable::CopyLookupSettings(
+    RainbowTable& Table
+) const
+{
+    Table.m_Threads = m_Threads;
+    Table.m_StorageType = m_StorageType;
+    Table.m_MmapAdvice = m_MmapAdvice;
+    Table.m_CacheSize = m_CacheSize;
+    Table.m_Mlock = m_Mlock;
+    Table.m_HugePageSize = m_HugePageSize;
+    Table.m_Prefault = m_Prefault;
+    Table.m_ShareIndex = m_ShareIndex;
+    Table.m_IndexDisable = m_IndexDisable;
+    Table.m_LearnedSearch = m_LearnedSearch;
+    Table.m_FilterBits = m_FilterBits;
+    Table.m_MergeJoin = m_MergeJoin;
+    Table.m_TableScan = m_TableScan;
+    Table.m_Scheduled = m_Scheduled;
+    Table.m_Pipelined = m_Pipelined;
+    Table.m_Readahead = m_Readahead;
+    Table.m_BudgetMs = m_BudgetMs;
+    Table.m_BruteForce = m_BruteForce;
+    Table.m_BruteForceLength = m_BruteForceLength;
+    Table.m_BruteForceMs = m_BruteForceMs;
+    Table.m_BruteForceLimit = m_BruteForceLimit;
+    Table.m_Separator = m_Separator;
+}
+
+std::optional<std::string>
+RainbowTable::ValidateChain(
+    const size_t ChainIndex,
+    const uint8_t* Target
+) const
+{
+    size_t length;
+    std::vector<uint8_t> hash(m_HashWidth);
+    std::vector<char> reduced(m_Max);
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+#ifdef BIGINT
+    mpz_class counter = WordGenerator::WordLengthIndex(m_Min, m_Charset);
+#else
+    uint64_t counter = WordGenerator::WordLengthIndex64(m_Min, m_Charset);
+#endif
+    counter += ChainIndex;
+
+    auto start = WordGenerator::GenerateWord(counter,m_Charset);
+    length = start.size();
+    memcpy(&reduced[0], start.c_str(), length);
+
+    for (size_t i = 0; i < m_Length; i++)
+    {
+        DoHash((uint8_t*)&reduced[0], length, &hash[0]);
+        if (memcmp(Target, &hash[0], m_HashWidth) == 0)
+        {
+            return std::string(&reduced[0], &reduced[length]);
+        }
+        length = reducer.Reduce(&reduced[0], m_Max, &hash[0], i);
+    }
+    return {};
+}
+
+RainbowTable::~RainbowTable(
+    void
+)
+{
+    Reset();
+}
+
+void
+RainbowTable::Reset(
+    void
+)
+{
+    UnmapTable();
+
+    m_Path.clear();
+    m_PathLoaded = false;
+    m_Algorithm = HashAlgorithmUndefined;
+    m_Min = 0;
+    m_Max = 0;
+    m_Length = 0;
+    m_Blocksize = 1024;
+    m_Count = 0;
+    m_Threads = 0;
+    m_Charset.clear();
+    m_HashWidth = 0;
+    m_ChainWidth = 0;
+    m_Chains = 0;
+    m_TableIndex = 0;
+    m_Family = 1;
+    m_TableType = TypeCompressed;
+    m_FingerprintBits = 32;
+    m_IndexBits = 0;
+    m_DeltaBits = 0;
+    // For cracking
+    m_StorageType = StorageMmap;
+    m_MmapAdvice.clear();
+    m_CacheSize = 64 * 1024 * 1024;
+    m_Mlock = false;
+    m_HugePageSize = 0;
+    m_Prefault = false;
+    m_ShareIndex = false;
+    m_IndexDisable = false;
+    m_LearnedSearch = false;
+    m_LearnedIndex.Clear();
+    m_FilterBits = 0;
+    m_Filter.Clear();
+    m_MergeJoin = false;
+    m_TableScan = false;
+    m_BudgetMs = 0;
+    m_ColumnSearched.clear();
+    m_ColumnProbabilities.clear();
+    m_LastProbability = 0.0;
+    m_BudgetExceeded = false;
+    m_Scheduled = false;
+    m_Pipelined = false;
+    m_Readahead = false;
+    m_BruteForce = false;
+    m_BruteForceLength = 0;
+    m_BruteForceMs = 0;
+    m_BruteForceLimit = 0;
+    m_Solved.clear();
+    // Shards are tables of their own and release their mappings
+    m_ShardRanges.clear();
+    m_Shards.clear();
+    m_Remote.reset();
+    m_Distributed = false;
+    m_Separator = ':';
+    m_Cracked = false;
+    m_CrackedResults.clear();
+    // For building
+    m_StartingChains = 0;
+    m_ChainsWritten = 0;
+    m_ThreadTimers.clear();
+    m_TargetSuccess = 0.0;
+    m_MinGain = 0.0;
+    m_BuildKeyspace = 0.0;
+    m_BuildSuccess = 0.0;
+    m_EndpointEstimates.clear();
+    m_StopBlock = std::numeric_limits<size_t>::max();
+    m_WriteHandles.clear();
+    m_NextWriteBlock = 0;
+    m_WriteCache.clear();
+    if (m_DispatchPool != nullptr)
+    {
+        m_DispatchPool->Stop();
+        m_DispatchPool->Wait();
+        m_DispatchPool = nullptr;
+    }
+    m_ThreadsCompleted = 0;
+}
+
+#ifdef __APPLE__
+int
+SortCompareEndpoints(
+    void* Arguments,
+    const void* Comp1,
+    const void* Comp2
+)
+{
+    return memcmp((uint8_t*)Comp1 + sizeof(rowindex_t), (uint8_t*)Comp2 + sizeof(rowindex_t), (size_t)Arguments);
+}
+#else
+int
+SortCompareEndpoints(
+    const void* Comp1,
+    const void* Comp2,
+    void* Arguments
+)
+{
+    return memcmp((uint8_t*)Comp1 + sizeof(rowindex_t), (uint8_t*)Comp2 + sizeof(rowindex_t), (size_t)Arguments);
+}
+#endif
+
+int
+SortComparePairs(
+    const void* Comp1,
+    const void* Comp2
+)
+{
+    // Records are (key, index) pairs
+    const uint64_t* const a = (uint64_t*)Comp1;
+    const uint64_t* const b = (uint64_t*)Comp2;
+    if (a[0] != b[0])
+    {
+        return a[0] < b[0] ? -1 : 1;
+    }
+    return a[1] < b[1] ? -1 : a[1] > b[1];
+}
+
+int
+SortCompareStartpoints(
+    const void* Comp1,
+    const void* Comp2
+)
+{
+    return *((rowindex_t*)Comp1) - *((rowindex_t*)Comp2);
+}
+
+void
+RainbowTable::SortStartpoints(
+    void
+)
+{
+    if (!MapTable(false))
+    {
+        std::cerr << "Error mapping table for sort"  << std::endl;
+        return;
+    }
+
+    uint8_t* start = m_MappedTable + sizeof(TableHeader);
+    if (m_TableType == TypeCompressed)
+    {
+        std::cerr << "Unable to sort compressed tables by start point" << std::endl;
+        return;
+    }
+
+    qsort(start, GetCount(), GetChainWidth(), SortCompareStartpoints);
+}
+
+void
+RainbowTable::SortTable(
+    void
+)
+{
+    if (!MapTable(false))
+    {
+        std::cerr << "Error mapping table for sort"  << std::endl;
+        return;
+    }
+
+    uint8_t* start = m_MappedTable + sizeof(TableHeader);
+    if (m_TableType == TypeUncompressed)
+    {
+#ifdef __APPLE__
+        qsort_r(start, GetCount(), GetChainWidth(), (void*)m_Max, SortCompareEndpoints);
+#else
+        qsort_r(start, GetCount(), GetChainWidth(), SortCompareEndpoints, (void*)m_Max);
+#endif
+    }
+    else
+    {
+        qsort(start, GetCount(), GetChainWidth(), SortCompareStartpoints);
+    }
+}
+
+void
+RainbowTable::RemoveStartpoints(
+    void
+)
+{
+    // Ensure the table is mapped writable
+    if (!MapTable(false))
+    {
+        std::cerr << "Unable to map the table" << std::endl;
+        return;
+    }
+
+    // Change the table type in the header
+    SetHeaderType(*(TableHeader*)m_MappedTable, TypeCompressed);
+
+    // Loop through the chains
+    uint8_t* tableBase = m_MappedTable + sizeof(TableHeader);
+    uint8_t* writepointer = tableBase;
+    for (size_t chain = 0; chain < GetCount(); chain++)
+    {
+        uint8_t* endpoint = tableBase + (chain * ChainWidthForType(TypeUncompressed, GetMax())) + sizeof(rowindex_t);
+        memmove(writepointer, endpoint, GetMax());
+        writepointer += GetMax();
+    }
+
+    // Truncate the file
+    if (!UnmapTable())
+    {
+        std::cerr << "Error unmapping table after removing start points" << std::endl;
+        return;
+    }
+
+    size_t newSize = sizeof(TableHeader) + (GetCount() * GetMax());
+    auto result = truncate(m_Path.c_str(), newSize);
+    if (result != 0)
+    {
+        std::cerr << "Error truncating file" << std::endl;
+        return;
+    }
+}
+
+void
+RainbowTable::ChangeType(
+    const std::filesystem::path& Destination,
+    const TableType Type
+)
+{
+    FILE* fhw;
+    TableHeader hdr;
+
+    if (m_TableType == Type)
+    {
+        std::cerr << "Won't convert to same type" << std::endl;
+        return;
+    }
+
+    if (IsPackedType(m_TableType))
+    {
+        std::cerr << "Unable to convert from a " << GetType() << " table" << std::endl;
+        return;
+    }
+
+    if (Type == TypeFingerprint)
+    {
+        ConvertToFingerprint(Destination);
+        return;
+    }
+
+    if (Type == TypeDelta)
+    {
+        ConvertToDelta(Destination);
+        return;
+    }
+
+    if (Type == TypeEytzinger)
+    {
+        ConvertToEytzinger(Destination);
+        return;
+    }
+
+    if (Type == TypeColumnar)
+    {
+        ConvertToColumnar(Destination);
+        return;
+    }
+
+    // Output some basic information about the
+    // current table
+    std::cout << "Table type: " << GetType() << std::endl;
+    std::cout << "Chain width: " << GetChainWidth() << std::endl;
+    std::cout << "Exporting " << m_Chains << " chains" << std::endl;
+
+    // If we are converting to a compressed file we need to do
+    // it in two stages. We need a full copy of the file so that
+    // we can then sort it by start points. Then we remove all 
+    // startpoints from the file
+    if (Type == TypeCompressed)
+    {
+        if (!std::filesystem::copy_file(m_Path, Destination, std::filesystem::copy_options::overwrite_existing))
+        {
+            std::cerr << "Error copying file for conversion" << std::endl;
+            return;
+        }
+    }
+    else
+    {
+        // Map the current table to memory
+        if (!MapTable(true))
+        {
+            std::cerr << "Error mapping table"  << std::endl;
+            return;
+        }
+
+        // Copy the existing header but change the type to uncompressed
+        hdr = *((TableHeader*)m_MappedTable);
+        SetHeaderType(hdr, TypeUncompressed);
+
+        // Open the destination for writing
+        fhw = fopen(Destination.c_str(), "w");
+        if (fhw == nullptr)
+        {
+            std::cerr << "Error opening desination table for write: " << Destination << std::endl;
+            return;
+        }
+
+        // Write the header
+        fwrite(&hdr, sizeof(hdr), 1, fhw);
+
+        // Pointer to track the next read target
+        uint8_t* next = m_MappedTable + sizeof(TableHeader);
+
+        // Loop through and write each index followed by the next endpoint
+        for (rowindex_t index = 0; index < m_Chains; index++, next += GetChainWidth())
+        {
+            fwrite(&index, sizeof(rowindex_t), 1, fhw);
+            fwrite(next, sizeof(char), m_Max, fhw);
+        }
+        fclose(fhw);
+    }
+
+    // Perform sort and cleanup work on the new table
+    RainbowTable newtable;
+    newtable.SetPath(Destination);
+
+    if (!newtable.ValidTable())
+    {
+        std::cerr << "Decompressed table does not seem valid" << std::endl;
+        return;
+    }
+
+    if (!newtable.LoadTable())
+    {
+        std::cerr << "Error loading new table" << std::endl;
+        return;
+    }
+
+    std::cout << "Sorting " << newtable.GetCount() << " chains" << std::endl;
+
+    if (m_TableType == TypeCompressed)
+    {
+        newtable.SortTable();
+    }
+    else
+    {
+        // Sort the table by startpoint
+        newtable.SortStartpoints();
+        // Remove all startpoints and truncate
+        newtable.RemoveStartpoints();
+    }
+}
+
+/* static */ const Chain
+RainbowTable::GetChain(
+    const std::filesystem::path& Path,
+    const size_t Index
+)
+{
+    TableHeader hdr;
+    Chain chain;
+    if (!GetTableHeader(Path, &hdr))
+    {
+        std::cerr << "Unable to read table header" << std::endl;
+        return chain;
+    }
+
+    // Packed tables have no fixed width records to seek to
+    const TableType type = GetHeaderType(hdr);
+    if (IsPackedType(type))
+    {
+        std::cerr << "Unable to read chains from a " << TypeToString(type) << " table" << std::endl;
+        return chain;
+    }
+
+    std::string charset(&hdr.charset[0], &hdr.charset[hdr.charsetlen]);
+
+    chain.SetIndex(Index);
+    chain.SetLength(hdr.length);
+
+    FILE* fh = fopen(Path.c_str(), "r");
+    if (fh == nullptr)
+    {
+        std::cerr << "Unable to open " << Path << std::endl;
+        return chain;
+    }
+    fseek(fh, sizeof(TableHeader), SEEK_SET);
+    fseek(fh, ChainWidthForType(type, hdr.max) * Index, SEEK_CUR);
+
+    rowindex_t start = Index;
+    if (type == TypeUncompressed)
+    {
+        fread(&start, sizeof(rowindex_t), 1, fh);
+    }
+    mpz_class lowerbound = WordGenerator::WordLengthIndex(hdr.min, charset);
+    static_assert(sizeof(rowindex_t) == 4 || (sizeof(unsigned long int) == sizeof(rowindex_t)));
+    auto word = WordGenerator::GenerateWord(lowerbound + (unsigned long int)start, charset);
+    chain.SetStart(word);
+
+    std::string endpoint;
+    endpoint.resize(hdr.max);
+    fread(&endpoint[0], sizeof(char), hdr.max, fh);
+    fclose(fh);
+    // Trim nulls
+    endpoint.resize(strlen(endpoint.c_str()));
+    chain.SetEnd(endpoint);
+
+    return chain;
+}
+
+/* static */ const Chain
+RainbowTable::ComputeChain(
+    const size_t Index,
+    const size_t Min,
+    const size_t Max,
+    const size_t Length,
+    const HashAlgorithm Algorithm,
+    const std::string& Charset,
+    const size_t TableIndex
+)
+{
+    mpz_class counter;
+    Chain chain;
+    size_t hashLength;
+    std::string start;
+
+    hashLength = GetHashWidth(Algorithm);
+
+    chain.SetIndex(Index);
+    chain.SetLength(Length);
+
+    counter = WordGenerator::WordLengthIndex(Min, Charset);
+    counter += Index;
+
+    start = WordGenerator::GenerateWord(counter, Charset);
+    chain.SetStart(start);
+
+    HybridReducer reducer(Min, Max, hashLength, Charset, TableIndex);
+
+    std::vector<uint8_t> hash(hashLength);
+    std::vector<char> reduced(Max);
+    size_t reducedLength = start.size();
+
+    memcpy(&reduced[0], start.c_str(), reducedLength);
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        DoHash((uint8_t*)&reduced[0], reducedLength, &hash[0], Algorithm);
+        reducedLength = reducer.Reduce(&reduced[0], Max, &hash[0], i);
+    }
+
+    chain.SetEnd(std::string(&reduced[0], &reduced[reducedLength]));
+    return chain;
+}
+
+const uint64_t
+RainbowTable::GetFingerprint(
+    const char* Endpoint,
+    const size_t Length
+) const
+{
+    // Endpoints are hashed null-padded as they are stored
+    std::vector<uint8_t> padded(m_Max);
+    memcpy(&padded[0], Endpoint, Length);
+    return Util::Hash64(&padded[0], m_Max) >> (64 - m_FingerprintBits);
+}
+
+const uint64_t
+RainbowTable::GetFingerprintAt(
+    const size_t Index
+) const
+{
+    const size_t offset = Index * (m_FingerprintBits + m_IndexBits);
+    return BitPacking::Read(GetPackedData(), offset, m_FingerprintBits);
+}
+
+const rowindex_t
+RainbowTable::GetFingerprintIndexAt(
+    const size_t Index
+) const
+{
+    const size_t offset = Index * (m_FingerprintBits + m_IndexBits) + m_FingerprintBits;
+    return BitPacking::Read(GetPackedData(), offset, m_IndexBits);
+}
+
+const size_t
+RainbowTable::FindFingerprint(
+    const uint64_t Fingerprint
+) const
+{
+    // Find the first record with a fingerprint not less than the target
+    size_t low = 0;
+    size_t high = m_Chains;
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        if (GetFingerprintAt(mid) < Fingerprint)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool
+RainbowTable::WriteSortedPairs(
+    const std::filesystem::path& Temporary,
+    const std::function<uint64_t(const uint8_t*)>& KeyFunction,
+    rowindex_t* MaxIndex
+)
+{
+    if (!MapTable(true))
+    {
+        std::cerr << "Error mapping table"  << std::endl;
+        return false;
+    }
+
+    // Write out (key, index) pairs to a temporary
+    // file so that they can be sorted on disk
+    FILE* fht = fopen(Temporary.c_str(), "w+");
+    if (fht == nullptr)
+    {
+        std::cerr << "Error opening temporary file for write: " << Temporary << std::endl;
+        return false;
+    }
+
+    *MaxIndex = 0;
+    for (size_t chain = 0; chain < m_Chains; chain++)
+    {
+        uint64_t pair[2];
+        pair[0] = KeyFunction(GetEndpointAt(chain));
+        pair[1] = m_TableType == TypeUncompressed ? *(rowindex_t*)GetRecordAt(chain) : chain;
+        *MaxIndex = std::max(*MaxIndex, pair[1]);
+        fwrite(pair, sizeof(pair), 1, fht);
+    }
+    fflush(fht);
+
+    const size_t pairsSize = m_Chains * sizeof(uint64_t) * 2;
+    if (pairsSize > 0)
+    {
+        uint64_t* pairs = (uint64_t*)mmap(nullptr, pairsSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(fht), 0);
+        if (pairs == MAP_FAILED)
+        {
+            std::cerr << "Unable to map temporary file into memory: " << strerror(errno) << std::endl;
+            fclose(fht);
+            return false;
+        }
+
+        std::cout << "Sorting " << m_Chains << " keys" << std::endl;
+        qsort(pairs, m_Chains, sizeof(uint64_t) * 2, SortComparePairs);
+        munmap(pairs, pairsSize);
+    }
+
+    fclose(fht);
+    return true;
+}
+
+void
+RainbowTable::ConvertViaUncompressed(
+    const std::filesystem::path& Destination,
+    const TableType Type
+)
+{
+    std::filesystem::path temporary = Destination;
+    temporary += ".utbl.tmp";
+    ChangeType(temporary, TypeUncompressed);
+
+    RainbowTable sorted;
+    sorted.SetPath(temporary);
+    if (sorted.LoadTable())
+    {
+        sorted.ChangeType(Destination, Type);
+    }
+    std::filesystem::remove(temporary);
+}
+
+FILE*
+RainbowTable::CreatePackedTable(
+    const std::filesystem::path& Destination,
+    const TableType Type,
+    const PackedHeader& Packed
+)
+{
+    // Opened for update so that layouts can be written through a mapping
+    FILE* fhw = fopen(Destination.c_str(), "w+");
+    if (fhw == nullptr)
+    {
+        std::cerr << "Error opening desination table for write: " << Destination << std::endl;
+        return nullptr;
+    }
+
+    TableHeader hdr = *((TableHeader*)m_MappedTable);
+    SetHeaderType(hdr, Type);
+    fwrite(&hdr, sizeof(hdr), 1, fhw);
+    fwrite(&Packed, sizeof(Packed), 1, fhw);
+    return fhw;
+}
+
+void
+RainbowTable::ConvertToFingerprint(
+    const std::filesystem::path& Destination
+)
+{
+    if (m_FingerprintBits < 8 || m_FingerprintBits > BitPacking::kMaxBits)
+    {
+        std::cerr << "Fingerprint bits must be between 8 and " << BitPacking::kMaxBits << std::endl;
+        return;
+    }
+
+    std::cout << "Fingerprinting " << m_Chains << " chains" << std::endl;
+
+    std::filesystem::path temporary = Destination;
+    temporary += ".tmp";
+    rowindex_t maxIndex;
+    const size_t shift = 64 - m_FingerprintBits;
+    const size_t max = m_Max;
+    if (!WriteSortedPairs(temporary, [shift, max](const uint8_t* Endpoint) { return Util::Hash64(Endpoint, max) >> shift; }, &maxIndex))
+    {
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    m_IndexBits = BitPacking::BitsRequired(maxIndex);
+    if (m_IndexBits > BitPacking::kMaxBits)
+    {
+        std::cerr << "Too many chains to pack start indices" << std::endl;
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    PackedHeader packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.count = m_Chains;
+    packed.keybits = m_FingerprintBits;
+    packed.indexbits = m_IndexBits;
+
+    FILE* fht = fopen(temporary.c_str(), "r");
+    FILE* fhw = CreatePackedTable(Destination, TypeFingerprint, packed);
+    if (fht != nullptr && fhw != nullptr)
+    {
+        BitPacking::BitWriter writer(fhw);
+        uint64_t pair[2];
+        while (fread(pair, sizeof(pair), 1, fht) == 1)
+        {
+            writer.Write(pair[0], m_FingerprintBits);
+            writer.Write(pair[1], m_IndexBits);
+        }
+        writer.Flush(true);
+
+        std::cout << "Packed " << m_FingerprintBits + m_IndexBits << " bits per chain ("
+                  << m_FingerprintBits << " fingerprint, " << m_IndexBits << " index)" << std::endl;
+    }
+
+    if (fhw != nullptr)
+    {
+        fclose(fhw);
+    }
+    if (fht != nullptr)
+    {
+        fclose(fht);
+    }
+    std::filesystem::remove(temporary);
+}
+
+void
+RainbowTable::ConvertToDelta(
+    const std::filesystem::path& Destination
+)
+{
+    if (!m_EndpointKey.Exact())
+    {
+        std::cerr << "Endpoints are too wide to delta encode (max " << m_EndpointKey.Width() << " characters)" << std::endl;
+        return;
+    }
+
+    // Every block needs a first key, so there must be one chain
+    if (m_Chains == 0)
+    {
+        std::cerr << "Table has no chains to delta encode" << std::endl;
+        return;
+    }
+
+    std::filesystem::path temporary = Destination;
+    temporary += ".tmp";
+    rowindex_t maxIndex;
+    const EndpointKey endpointKey = m_EndpointKey;
+    if (!WriteSortedPairs(temporary, [&endpointKey](const uint8_t* Endpoint) { return endpointKey.Key(Endpoint); }, &maxIndex))
+    {
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    m_IndexBits = BitPacking::BitsRequired(maxIndex);
+    if (m_IndexBits > BitPacking::kMaxBits)
+    {
+        std::cerr << "Too many chains to pack start indices" << std::endl;
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    FILE* fht = fopen(temporary.c_str(), "r");
+    if (fht == nullptr)
+    {
+        std::cerr << "Error opening temporary file for read: " << temporary << std::endl;
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    // Choose the Rice parameter from the mean gap between keys
+    uint64_t first[2] = {0, 0};
+    uint64_t last[2] = {0, 0};
+    if (m_Chains > 0)
+    {
+        fread(first, sizeof(first), 1, fht);
+        fseek(fht, -(long)sizeof(last), SEEK_END);
+        fread(last, sizeof(last), 1, fht);
+        fseek(fht, 0, SEEK_SET);
+    }
+    const double meanDelta = m_Chains > 1 ? (double)(last[0] - first[0]) / (m_Chains - 1) : 1.f;
+    m_DeltaBits = meanDelta * M_LN2 >= 2.f ? (size_t)std::log2(meanDelta * M_LN2) : 0;
+    m_DeltaBits = std::min(m_DeltaBits, (size_t)32);
+
+    PackedHeader packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.count = m_Chains;
+    packed.keybits = m_DeltaBits;
+    packed.indexbits = m_IndexBits;
+    packed.blocksize = kDeltaBlockSize;
+
+    FILE* fhw = CreatePackedTable(Destination, TypeDelta, packed);
+    if (fhw == nullptr)
+    {
+        fclose(fht);
+        std::filesystem::remove(temporary);
+        return;
+    }
+
+    // Each block stores the start indices for its chains followed
+    // by the Rice coded gaps between consecutive keys. The first key
+    // of each block is kept in a directory at the end of the file
+    std::vector<DeltaBlock> directory;
+    directory.reserve((m_Chains + kDeltaBlockSize - 1) / kDeltaBlockSize);
+    BitPacking::BitWriter writer(fhw);
+    std::vector<uint64_t> pairs(kDeltaBlockSize * 2);
+    size_t entries;
+    while ((entries = fread(&pairs[0], sizeof(uint64_t) * 2, kDeltaBlockSize, fht)) > 0)
+    {
+        directory.push_back({pairs[0], writer.BitsWritten()});
+        for (size_t entry = 0; entry < entries; entry++)
+        {
+            writer.Write(pairs[entry * 2 + 1], m_IndexBits);
+        }
+        for (size_t entry = 1; entry < entries; entry++)
+        {
+            const uint64_t delta = pairs[entry * 2] - pairs[(entry - 1) * 2];
+            // Quotient in unary followed by the remainder
+            uint64_t quotient = delta >> m_DeltaBits;
+            for (; quotient >= 32; quotient -= 32)
+            {
+                writer.Write(0xffffffff, 32);
+            }
+            writer.Write((1ull << quotient) - 1, quotient + 1);
+            writer.Write(delta, m_DeltaBits);
+        }
+    }
+    writer.Flush(true);
+    fwrite(&directory[0], sizeof(DeltaBlock), directory.size(), fhw);
+    fclose(fhw);
+    fclose(fht);
+    std::filesystem::remove(temporary);
+
+    const double bitsPerChain = (double)(std::filesystem::file_size(Destination) - sizeof(TableHeader)) * 8 / m_Chains;
+    std::cout << "Packed " << std::fixed << std::setprecision(1) << bitsPerChain << " bits per chain ("
+              << m_DeltaBits << " bit Rice parameter, " << m_IndexBits << " bit index)" << std::endl;
+}
+
+const size_t
+RainbowTable::FindDelta(
+    const char* Endpoint,
+    const size_t Length
+) const
+{
+    uint8_t padded[MAX_LENGTH] = {0};
+    memcpy(&padded[0], Endpoint, Length);
+    const uint64_t key = m_EndpointKey.Key(&padded[0]);
+
+    // Find the last block starting at or before the key
+    const PackedHeader* const packed = GetPackedHeader();
+    const size_t blocks = (packed->count + packed->blocksize - 1) / packed->blocksize;
+    const DeltaBlock* const directory = GetDeltaDirectory();
+    size_t low = 0;
+    size_t high = blocks;
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        if (directory[mid].key <= key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    if (low == 0)
+    {
+        return (size_t)-1;
+    }
+
+    // Decode the block until we reach or pass the key
+    const size_t block = low - 1;
+    const size_t entries = std::min((size_t)packed->blocksize, packed->count - block * packed->blocksize);
+    const uint8_t* const stream = GetPackedData();
+    size_t offset = directory[block].offset + entries * m_IndexBits;
+    uint64_t current = directory[block].key;
+    for (size_t entry = 0; entry < entries; entry++)
+    {
+        if (entry > 0)
+        {
+            uint64_t quotient = 0;
+            uint64_t bits;
+            while ((bits = BitPacking::Read(stream, offset, BitPacking::kMaxBits)) == (1ull << BitPacking::kMaxBits) - 1)
+            {
+                quotient += BitPacking::kMaxBits;
+                offset += BitPacking::kMaxBits;
             }
+            const size_t ones = __builtin_ctzll(~bits);
+            quotient += ones;
+            offset += ones + 1;
+            current += (quotient << m_DeltaBits) | BitPacking::Read(stream, offset, m_DeltaBits);
+            offset += m_DeltaBits;
         }
-    } while(foundNewEntry);
 
-    // Calculate the counts
-    // We walk through each item, look for the next offset
-    // and calculate the distance between them
-    for (size_t i = 0; i < LOOKUP_SIZE; i++)
+        if (current == key)
+        {
+            return BitPacking::Read(stream, directory[block].offset + entry * m_IndexBits, m_IndexBits);
+        }
+        else if (current > key)
+        {
+            break;
+        }
+    }
+    return (size_t)-1;
+}
+
+void
+RainbowTable::ConvertToEytzinger(
+    const std::filesystem::path& Destination
+)
+{
+    // The layout is built from a sorted table
+    if (m_TableType == TypeCompressed)
+    {
+        ConvertViaUncompressed(Destination, TypeEytzinger);
+        return;
+    }
+
+    if (!MapTable(true))
+    {
+        std::cerr << "Error mapping table"  << std::endl;
+        return;
+    }
+
+    // Keys are full endpoints when they fit in 64 bits, otherwise
+    // they are a prefix and the record must also be compared.
+    // Exact keys only need the start index stored beside them
+    PackedHeader packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.count = m_Chains;
+    packed.keybits = sizeof(uint64_t) * 8;
+
+    FILE* fhw = CreatePackedTable(Destination, TypeEytzinger, packed);
+    if (fhw == nullptr)
+    {
+        return;
+    }
+
+    // Size the file and map it so that slots can be written in any order
+    const size_t recordWidth = GetEytzingerRecordWidth();
+    const size_t fileSize = kAlignedDataOffset + (m_Chains + 1) * (sizeof(uint64_t) + recordWidth);
+    fflush(fhw);
+    if (ftruncate(fileno(fhw), fileSize) != 0)
+    {
+        std::cerr << "Error resizing destination table" << std::endl;
+        fclose(fhw);
+        return;
+    }
+
+    uint8_t* mapped = (uint8_t*)mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(fhw), 0);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Unable to map destination table into memory: " << strerror(errno) << std::endl;
+        fclose(fhw);
+        return;
+    }
+
+    uint64_t* const keys = (uint64_t*)(mapped + kAlignedDataOffset);
+    uint8_t* const records = (uint8_t*)&keys[m_Chains + 1];
+
+    std::cout << "Laying out " << m_Chains << " chains" << std::endl;
+
+    // Slot k has children 2k and 2k+1. Walking the implicit tree
+    // in order visits the slots in the order of the sorted table
+    std::vector<size_t> stack;
+    size_t slot = 1;
+    size_t chain = 0;
+    while (slot <= m_Chains || !stack.empty())
     {
-        // Find the next closest offset
-        const uint8_t* const offset = m_MappedTableLookup[i];
-        if (offset == nullptr)
+        if (slot <= m_Chains)
         {
+            stack.push_back(slot);
+            slot *= 2;
             continue;
         }
+        slot = stack.back();
+        stack.pop_back();
+        keys[slot] = m_EndpointKey.Key(GetEndpointAt(chain));
+        memcpy(records + slot * recordWidth, GetRecordAt(chain), recordWidth);
+        chain++;
+        slot = slot * 2 + 1;
+    }
+
+    munmap(mapped, fileSize);
+    fclose(fhw);
+}
+
+const size_t
+RainbowTable::FindEytzinger(
+    const char* Endpoint
+) const
+{
+    const uint64_t key = m_EndpointKey.Key((uint8_t*)Endpoint);
+
+    // Descend the implicit tree without branching on the
+    // comparison. The sixteen descendants four levels down
+    // fill two cache lines which are fetched ahead of time
+    const uint64_t* const keys = GetEytzingerKeys();
+    size_t slot = 1;
+    while (slot <= m_Chains)
+    {
+        __builtin_prefetch(keys + slot * 16);
+        __builtin_prefetch(keys + slot * 16 + 8);
+        slot = 2 * slot + (keys[slot] < key);
+    }
+
+    // Undo the final right turns to find the first key that
+    // is not less than the endpoint
+    slot >>= __builtin_ffsll(~slot);
+
+    // Prefix keys can be shared so walk the in-order
+    // successors until the key changes
+    while (slot != 0 && keys[slot] == key)
+    {
+        const uint8_t* const record = GetEytzingerRecord(slot);
+        if (m_EndpointKey.Exact() || memcmp(record + sizeof(rowindex_t), Endpoint, m_Max) == 0)
+        {
+            return *(rowindex_t*)record;
+        }
 
-        const uint8_t* next = nullptr;
-        for (size_t j = 0; j < LOOKUP_SIZE; j++)
+        if (2 * slot + 1 <= m_Chains)
         {
-            if (i != j
-                && m_MappedTableLookup[j] != nullptr
-                && m_MappedTableLookup[j] > m_MappedTableLookup[i]
-                && (next == nullptr || m_MappedTableLookup[j] < next))
+            slot = 2 * slot + 1;
+            while (2 * slot <= m_Chains)
             {
-                next = m_MappedTableLookup[j];
+                slot *= 2;
             }
         }
+        else
+        {
+            slot >>= __builtin_ffsll(~slot);
+        }
+    }
+    return (size_t)-1;
+}
+
+void
+RainbowTable::ConvertToColumnar(
+    const std::filesystem::path& Destination
+)
+{
+    // The layout is built from a sorted table
+    if (m_TableType == TypeCompressed)
+    {
+        ConvertViaUncompressed(Destination, TypeColumnar);
+        return;
+    }
+
+    if (!MapTable(true))
+    {
+        std::cerr << "Error mapping table"  << std::endl;
+        return;
+    }
+
+    PackedHeader packed;
+    memset(&packed, 0, sizeof(packed));
+    packed.count = m_Chains;
+    packed.keybits = sizeof(uint64_t) * 8;
+
+    FILE* fhw = CreatePackedTable(Destination, TypeColumnar, packed);
+    if (fhw == nullptr)
+    {
+        return;
+    }
+
+    std::cout << "Splitting " << m_Chains << " chains" << std::endl;
+
+    // Pad up to the start of the key array
+    const std::vector<uint8_t> padding(kAlignedDataOffset - sizeof(TableHeader) - sizeof(PackedHeader), 0);
+    fwrite(padding.data(), sizeof(uint8_t), padding.size(), fhw);
+
+    // Each column is written in a separate pass over the table
+    for (size_t i = 0; i < m_Chains; i++)
+    {
+        const uint64_t key = m_EndpointKey.Key(GetEndpointAt(i));
+        fwrite(&key, sizeof(key), 1, fhw);
+    }
 
-        assert(next == nullptr || next > offset);
-        assert(next == nullptr || (uint64_t)(next - offset) % chainWidth == 0);
+    for (size_t i = 0; i < m_Chains; i++)
+    {
+        fwrite(GetRecordAt(i), sizeof(rowindex_t), 1, fhw);
+    }
 
-        if(next != nullptr)
+    // Exact keys are the endpoints so they need not be stored
+    if (!m_EndpointKey.Exact())
+    {
+        for (size_t i = 0; i < m_Chains; i++)
         {
-            m_MappedTableLookupSize[i] = (next - m_MappedTableLookup[i]);
+            fwrite(GetEndpointAt(i), sizeof(uint8_t), m_Max, fhw);
         }
     }
 
-    // Handle the last entry
-    const uint8_t* max = nullptr;
-    size_t maxIndex = 0;
-    for (size_t i = 0; i < LOOKUP_SIZE; i++)
+    fclose(fhw);
+}
+
+const size_t
+RainbowTable::FindColumnar(
+    const char* Endpoint
+) const
+{
+    if (m_Chains == 0)
+    {
+        return (size_t)-1;
+    }
+
+    const uint64_t key = m_EndpointKey.Key((uint8_t*)Endpoint);
+
+    const uint64_t* const keys = GetColumnarKeys();
+    const uint64_t* base = keys;
+    size_t length = m_Chains;
+
+    // The learned index narrows the search to a small window
+    if (m_LearnedIndex.Trained())
+    {
+        const auto [first, last] = m_LearnedIndex.Range(key);
+        base = std::lower_bound(keys + first, keys + last, key);
+        length = 0;
+    }
+
+    // Branchless lower bound over the dense key array. Both
+    // possible next probes are prefetched each iteration
+    while (length > 1)
+    {
+        const size_t half = length / 2;
+        const size_t next = (length - half) / 2;
+        __builtin_prefetch(base + next - 1);
+        __builtin_prefetch(base + half + next - 1);
+        base += (base[half - 1] < key) * half;
+        length -= half;
+    }
+
+    // Only now is the payload touched. Prefix keys can be
+    // shared so check each record with a matching key
+    for (size_t record = base - keys; record < m_Chains && keys[record] == key; record++)
     {
-        if (m_MappedTableLookup[i] != nullptr
-            && m_MappedTableLookup[i] > max)
+        if (m_EndpointKey.Exact() || memcmp(GetColumnarEndpoint(record), Endpoint, m_Max) == 0)
         {
-            max = m_MappedTableLookup[i];
-            maxIndex = i;
+            return GetColumnarIndices()[record];
         }
     }
+    return (size_t)-1;
+}
+
+/* static */ bool
+RainbowTable::IsManifest(
+    const std::filesystem::path& Path
+)
+{
+    std::ifstream fs(Path);
+    std::string magic;
+    fs >> magic;
+    return magic == kManifestMagic;
+}
 
-    // Calculate final size
-    const uint8_t * const end = m_MappedTable + m_MappedTableSize;
-    m_MappedTableLookupSize[maxIndex] = (end - max);
+/* static */ const uint64_t
+RainbowTable::HashTableParameters(
+    const TableHeader& Header
+)
+{
+    return Util::Hash64((const uint8_t*)&Header, sizeof(Header));
+}
 
-    // Linear version
-#else
-    uint16_t last = *(uint16_t*)GetEndpointAt(0);
-    m_MappedTableLookup[last] = GetRecordAt(0);
-    size_t count = 1;
-    for (size_t i = 1; i < GetCount(); i++)
+bool
+RainbowTable::Split(
+    const std::filesystem::path& Destination,
+    const size_t Shards
+)
+{
+    if (m_TableType != TypeUncompressed)
+    {
+        std::cerr << "Only sorted uncompressed tables can be split" << std::endl;
+        return false;
+    }
+
+    if (Shards < 2 || m_Chains == 0)
+    {
+        std::cerr << "Need at least two shards and a non empty table" << std::endl;
+        return false;
+    }
+
+    if (!MapTable(true))
+    {
+        std::cerr << "Error mapping table" << std::endl;
+        return false;
+    }
+
+    // Count the chains under each prefix. The records must be
+    // sorted so that each prefix range is a contiguous run
+    std::vector<size_t> counts(LOOKUP_SIZE, 0);
+    uint16_t previous = 0;
+    for (size_t i = 0; i < m_Chains; i++)
+    {
+        const uint16_t prefix = GetEndpointPrefix(GetEndpointAt(i));
+        if (prefix < previous)
+        {
+            std::cerr << "Table is not sorted by endpoint" << std::endl;
+            return false;
+        }
+        counts[prefix]++;
+        previous = prefix;
+    }
+
+    // Close each shard once it holds its share of the chains.
+    // Shards are never empty so there may be fewer than asked for
+    const std::string stem = m_Path.stem().string();
+    std::vector<TableShard> shards;
+    size_t first = 0;
+    size_t chains = 0;
+    size_t seen = 0;
+    for (size_t prefix = 0; prefix < LOOKUP_SIZE; prefix++)
+    {
+        chains += counts[prefix];
+        seen += counts[prefix];
+        const bool full = chains > 0 && seen >= m_Chains * (shards.size() + 1) / Shards && shards.size() + 1 < Shards;
+        if (full || prefix == LOOKUP_SIZE - 1)
+        {
+            if (chains == 0)
+            {
+                shards.back().last = prefix;
+                break;
+            }
+            const std::string name = stem + "." + std::to_string(shards.size()) + ExtensionForType(TypeUncompressed);
+            shards.push_back({(uint16_t)first, (uint16_t)prefix, chains, name});
+            first = prefix + 1;
+            chains = 0;
+        }
+    }
+
+    std::filesystem::create_directories(Destination);
+    const TableHeader hdr = *((TableHeader*)m_MappedTable);
+    size_t record = 0;
+    for (const TableShard& shard : shards)
+    {
+        const std::filesystem::path path = Destination / shard.path;
+        FILE* fhw = fopen(path.c_str(), "w");
+        if (fhw == nullptr)
+        {
+            std::cerr << "Error opening shard for write: " << path << std::endl;
+            return false;
+        }
+
+        std::cout << "Writing " << shard.chains << " chains to " << path << std::endl;
+        fwrite(&hdr, sizeof(hdr), 1, fhw);
+        fwrite(GetRecordAt(record), GetChainWidth(), shard.chains, fhw);
+        fclose(fhw);
+        record += shard.chains;
+    }
+
+    // Shard paths are relative to the manifest so that the
+    // directory can be moved. They can be edited to point at
+    // shards that have been moved to other devices
+    const std::filesystem::path manifest = Destination / (stem + ".manifest");
+    std::ofstream fs(manifest);
+    fs << kManifestMagic << " " << kManifestVersion << std::endl;
+    fs << "parameters " << std::hex << std::setw(16) << std::setfill('0') << HashTableParameters(hdr) << std::endl;
+    fs << "chains " << std::dec << m_Chains << std::endl;
+    for (const TableShard& shard : shards)
+    {
+        fs << "shard " << std::hex << std::setw(4) << shard.first << " " << std::setw(4) << shard.last << " ";
+        fs << std::dec << shard.chains << " " << shard.path.string() << std::endl;
+    }
+    fs.close();
+
+    if (!fs)
+    {
+        std::cerr << "Error writing manifest: " << manifest << std::endl;
+        return false;
+    }
+
+    std::cout << "Wrote " << shards.size() << " shards and " << manifest << std::endl;
+    return true;
+}
+
+bool
+RainbowTable::Merge(
+    const std::vector<std::filesystem::path>& Tables,
+    const std::filesystem::path& Destination
+)
+{
+    // This table is the first input and the others must match it
+    std::vector<std::unique_ptr<RainbowTable>> others;
+    std::vector<RainbowTable*> inputs = {this};
+    if (m_TableType != TypeUncompressed || !MapTable(true))
+    {
+        std::cerr << "Only sorted uncompressed tables can be merged" << std::endl;
+        return false;
+    }
+    const TableHeader hdr = *((TableHeader*)m_MappedTable);
+    for (const auto& path : Tables)
+    {
+        std::error_code error;
+        if (std::filesystem::equivalent(path, Destination, error))
+        {
+            std::cerr << "Destination must not be one of the inputs" << std::endl;
+            return false;
+        }
+        if (path == m_Path)
+        {
+            continue;
+        }
+
+        auto table = std::make_unique<RainbowTable>();
+        table->SetPath(path);
+        if (!table->ValidTable() || !table->LoadTable() || !table->MapTable(true))
+        {
+            std::cerr << "Unable to load table " << path << std::endl;
+            return false;
+        }
+        if (table->m_TableType != TypeUncompressed ||
+            HashTableParameters(*((TableHeader*)table->m_MappedTable)) != HashTableParameters(hdr))
+        {
+            std::cerr << "Table " << path << " does not have the same parameters" << std::endl;
+            return false;
+        }
+        inputs.push_back(table.get());
+        others.push_back(std::move(table));
+    }
+
+    FILE* fhw = fopen(Destination.c_str(), "w");
+    if (fhw == nullptr)
+    {
+        std::cerr << "Error opening desination table for write: " << Destination << std::endl;
+        return false;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, fhw);
+
+    // K-way merge on the endpoint. Ties go to the earlier input so
+    // the start index kept for a duplicate endpoint is deterministic
+    const size_t width = m_Max;
+    std::vector<size_t> cursors(inputs.size(), 0);
+    auto greater = [&](const size_t A, const size_t B) {
+        const int cmp = memcmp(inputs[A]->GetEndpointAt(cursors[A]), inputs[B]->GetEndpointAt(cursors[B]), width);
+        return cmp != 0 ? cmp > 0 : A > B;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> queue(greater);
+    size_t total = 0;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        total += inputs[i]->m_Chains;
+        if (inputs[i]->m_Chains > 0)
+        {
+            queue.push(i);
+        }
+    }
+
+    std::cout << "Merging " << total << " chains from " << inputs.size() << " tables" << std::endl;
+    std::vector<uint8_t> last(width, 0);
+    size_t written = 0;
+    bool sorted = true;
+    while (!queue.empty())
+    {
+        const size_t input = queue.top();
+        queue.pop();
+        const uint8_t* const record = inputs[input]->GetRecordAt(cursors[input]);
+        const uint8_t* const endpoint = record + sizeof(rowindex_t);
+        const int cmp = written > 0 ? memcmp(endpoint, &last[0], width) : 1;
+        if (cmp < 0)
+        {
+            sorted = false;
+            break;
+        }
+        else if (cmp > 0)
+        {
+            fwrite(record, GetChainWidth(), 1, fhw);
+            memcpy(&last[0], endpoint, width);
+            written++;
+        }
+
+        if (++cursors[input] < inputs[input]->m_Chains)
+        {
+            queue.push(input);
+        }
+    }
+    fclose(fhw);
+
+    if (!sorted)
+    {
+        std::cerr << "Inputs are not sorted by endpoint" << std::endl;
+        std::filesystem::remove(Destination);
+        return false;
+    }
+
+    RainbowTable merged;
+    merged.SetPath(Destination);
+    if (!merged.LoadTable())
+    {
+        std::cerr << "Error loading merged table" << std::endl;
+        return false;
+    }
+
+    // Duplicate endpoints only add lookups, not coverage
+    std::cout << "Wrote " << written << " unique chains, dropped " << total - written << " duplicate endpoints" << std::endl;
+    std::cout << "Unique:      " << (total > 0 ? (double)written / total * 100 : 0) << "% of input chains" << std::endl;
+    std::cout << "KS Coverage: " << merged.GetCoverage() << std::endl;
+    std::cout << "Success:     " << merged.GetSuccessProbability() * 100 << "%" << std::endl;
+    return true;
+}
+
+bool
+RainbowTable::LoadManifest(
+    void
+)
+{
+    std::ifstream fs(m_Path);
+    std::string magic;
+    size_t version = 0;
+    fs >> magic >> version;
+    if (magic != kManifestMagic || version != kManifestVersion)
+    {
+        std::cerr << "Unsupported manifest version" << std::endl;
+        return false;
+    }
+
+    uint64_t parameters = 0;
+    size_t chains = 0;
+    std::string line;
+    m_ShardRanges.clear();
+    while (std::getline(fs, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "parameters")
+        {
+            fields >> std::hex >> parameters;
+        }
+        else if (key == "chains")
+        {
+            fields >> chains;
+        }
+        else if (key == "shard")
+        {
+            // The path is the rest of the line and may contain spaces
+            unsigned int first, last;
+            TableShard shard;
+            std::string path;
+            fields >> std::hex >> first >> last >> std::dec >> shard.chains >> std::ws;
+            std::getline(fields, path);
+            shard.first = first;
+            shard.last = last;
+            shard.path = path;
+            if (shard.path.is_relative() && !Socket::IsAddress(path))
+            {
+                shard.path = m_Path.parent_path() / shard.path;
+            }
+            if (!fields.eof() || path.empty())
+            {
+                std::cerr << "Invalid shard in manifest: " << line << std::endl;
+                return false;
+            }
+            m_ShardRanges.push_back(shard);
+        }
+        else if (!key.empty())
+        {
+            std::cerr << "Unknown manifest entry: " << key << std::endl;
+            return false;
+        }
+    }
+
+    // The shards must cover every prefix exactly once
+    size_t next = 0;
+    size_t total = 0;
+    for (const TableShard& shard : m_ShardRanges)
+    {
+        if (shard.first != next || shard.last < shard.first)
+        {
+            std::cerr << "Manifest shards do not cover every endpoint prefix" << std::endl;
+            return false;
+        }
+        next = shard.last + 1;
+        total += shard.chains;
+    }
+    if (next != LOOKUP_SIZE || total != chains)
+    {
+        std::cerr << "Manifest shards do not cover every endpoint prefix" << std::endl;
+        return false;
+    }
+
+    m_Shards.clear();
+    for (const TableShard& range : m_ShardRanges)
     {
-        const uint16_t index = *(uint16_t*)GetEndpointAt(i);
-        // New id, we need to walk back
-        if (index != last)
+        // Shards are searched with the same options as the table
+        auto shard = std::make_unique<RainbowTable>();
+        shard->SetPath(range.path);
+        CopyLookupSettings(*shard);
+
+        // Shards served by other processes describe themselves
+        TableHeader hdr;
+        if (Socket::IsAddress(range.path.string()))
         {
-            m_MappedTableLookupSize[last] = count * GetChainWidth();
-            m_MappedTableLookup[index] = GetRecordAt(i);
-            count = 1;
+            uint64_t chains = 0;
+            shard->m_Remote = std::make_unique<RemoteShard>();
+            if (!shard->m_Remote->Connect(range.path.string()) || !shard->m_Remote->Hello(&hdr, sizeof(hdr), &chains))
+            {
+                std::cerr << "Unable to reach shard " << range.path.string() << std::endl;
+                return false;
+            }
+            shard->SetParametersFromHeader(hdr);
+            shard->m_ChainWidth = shard->GetChainWidth();
+            shard->m_Chains = chains;
+            m_Distributed = true;
         }
-        else
+        else if (!shard->TableExists() || !GetTableHeader(range.path, &hdr) || !shard->LoadTable())
         {
-            count++;
+            std::cerr << "Unable to load shard " << range.path << std::endl;
+            return false;
         }
-        last = index;
+
+        // A rebuilt shard must have been made with the same parameters
+        if (HashTableParameters(hdr) != parameters ||
+            shard->m_TableType != TypeUncompressed ||
+            shard->m_Chains != range.chains)
+        {
+            std::cerr << "Shard " << range.path << " does not match the manifest" << std::endl;
+            return false;
+        }
+        m_Shards.push_back(std::move(shard));
     }
-    m_MappedTableLookupSize[last] = count * GetChainWidth();
-#endif
 
-    m_Indexed = true;
+    // The table takes the parameters of its shards
+    const RainbowTable& shard = *m_Shards[0];
+    m_TableType = shard.m_TableType;
+    m_Algorithm = shard.m_Algorithm;
+    m_Min = shard.m_Min;
+    m_Max = shard.m_Max;
+    m_Length = shard.m_Length;
+    m_Charset = shard.m_Charset;
+    m_HashWidth = shard.m_HashWidth;
+    m_EndpointKey = shard.m_EndpointKey;
+    m_ChainWidth = shard.m_ChainWidth;
+    m_Chains = total;
+    return true;
 }
 
-/* static */
-const std::string
-RainbowTable::DoHashHex(
-    const uint8_t* Data,
-    const size_t Length,
-    const HashAlgorithm Algorithm
+bool
+RainbowTable::PrepareShards(
+    void
 )
 {
-    uint8_t buffer[MAX_BUFFER_SIZE];
-    DoHash(Data, Length, buffer, Algorithm);
-    return Util::ToHex(buffer, GetHashWidth(Algorithm));
+    // Shards usually live on separate devices so they
+    // are loaded and indexed at the same time
+    std::vector<uint8_t> prepared(m_Shards.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < m_Shards.size(); i++)
+    {
+        threads.emplace_back([&, i]() { prepared[i] = m_Shards[i]->PrepareLookup(); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < m_Shards.size(); i++)
+    {
+        if (!prepared[i])
+        {
+            std::cerr << "Error preparing shard " << m_ShardRanges[i].path << std::endl;
+            return false;
+        }
+    }
+    return true;
 }
 
 const size_t
-RainbowTable::FindEndpoint(
-    const char* Endpoint,
-    const size_t Length
+RainbowTable::ShardFor(
+    const char* Endpoint
 ) const
 {
-    // We need a null-padded buffer to compare against
-    std::vector<char> comparitor(m_Max);
-    memcpy(&comparitor[0], Endpoint, Length);
+    // The first shard always starts at prefix zero
+    const uint16_t prefix = GetEndpointPrefix((const uint8_t*)Endpoint);
+    auto it = std::upper_bound(m_ShardRanges.begin(), m_ShardRanges.end(), prefix,
+        [](const uint16_t Prefix, const TableShard& Shard) { return Prefix < Shard.first; });
+    return it - m_ShardRanges.begin() - 1;
+}
 
-    const size_t chainWidth = GetChainWidth();
-    // Uncompressed tables are just flat files
-    // of endpoints, each of m_Max width. They are
-    // unsorted so we need to do a Linear search
-    if (m_TableType == TypeCompressed)
+std::string
+RainbowTable::GetStorageStats(
+    void
+) const
+{
+    if (!m_Shards.empty())
     {
-        const uint8_t* endpoint = m_MappedTable + sizeof(TableHeader);
-        for (
-            size_t c = 0;
-            c < m_Chains;
-            c++, endpoint += chainWidth)
+        std::string stats;
+        for (size_t i = 0; i < m_Shards.size(); i++)
         {
-            if (memcmp(endpoint, &comparitor[0], m_Max) == 0)
-            {
-                return c;
-            }
+            stats += (i > 0 ? ", " : "") + m_Shards[i]->GetStorageStats();
         }
+        return std::to_string(m_Shards.size()) + " shards: " + stats;
     }
-    // Uncompressed files are flat binary files of an
-    // unsigned integer index, followed by the text
-    // endpoint of m_Max width. They are sortd by endpoint
-    // so we can do a binary search
-    else
+    if (m_Remote != nullptr)
     {
-        // Lookup this endpoint offset and length
-        uint16_t index = *(uint16_t*)Endpoint;
-        const uint8_t* const base = m_Indexed ? m_MappedTableLookup[index] : m_MappedTable + sizeof(TableHeader);
-        const uint8_t* const top = m_Indexed ? (uint8_t*) base + m_MappedTableLookupSize[index] : (uint8_t*) base + m_MappedTableSize - sizeof(TableHeader);
+        return m_Remote->Stats();
+    }
+    return m_Storage != nullptr ? m_Storage->Stats() : "unmapped";
+}
 
-        // Endpoint not found in lookup table
-        if (base == nullptr)
+bool
+RainbowTable::ValidateMatches(
+    const std::vector<MergeMatch>& Matches,
+    const std::vector<std::vector<uint8_t>>& Targets,
+    std::vector<std::optional<std::string>>& Results
+) const
+{
+    if (m_Remote != nullptr)
+    {
+        std::vector<std::pair<uint64_t, const uint8_t*>> chains;
+        for (const MergeMatch& match : Matches)
         {
-            return (size_t)-1;
+            chains.push_back({match.start, &Targets[match.target][0]});
         }
+        return m_Remote->Validate(chains, m_HashWidth, m_Max, Results);
+    }
 
-        // Perform the search
-        const uint8_t* low = (uint8_t*) base;
-        const uint8_t* high = (uint8_t*) top - chainWidth;
-        const uint8_t* mid;
-
-        while (low <= high)
+    // Matches are grouped by target so the rest of a
+    // group is skipped once one of them validates
+    Results.assign(Matches.size(), std::nullopt);
+    uint32_t solved = std::numeric_limits<uint32_t>::max();
+    for (size_t i = 0; i < Matches.size(); i++)
+    {
+        if (Matches[i].target != solved)
         {
-            // Calculate the midpoint record offset
-            mid = low + ((high - low) / (2 * chainWidth)) * chainWidth;
-            // The endpoint for the mid point
-            const uint8_t* const endpoint = mid + sizeof(rowindex_t);
-            int cmp = memcmp(endpoint, &comparitor[0], m_Max);
-            if (cmp == 0)
-            {
-                rowindex_t* index = (rowindex_t*)endpoint - 1;
-                return (size_t)*index;
-            }
-            else if (cmp < 0)
-            {
-                low = mid + chainWidth;
-            }
-            else
-            {
-                high = mid - chainWidth;
-            }
+            Results[i] = ValidateChain(Matches[i].start, &Targets[Matches[i].target][0]);
+            solved = Results[i].has_value() ? Matches[i].target : solved;
         }
     }
-    return (size_t)-1;
+    return true;
 }
 
-// Checks a chain assuming the given iteration
-std::optional<std::string>
-RainbowTable::CheckIteration(
-    const HybridReducer& Reducer,
-    const std::vector<uint8_t>& Target,
-    const size_t Iteration
-) const
+bool
+RainbowTable::Serve(
+    const std::string& Address
+)
 {
-    uint8_t hash[m_HashWidth];
-    char    reduced[m_Max];
-    size_t  length;
-
-    memcpy(&hash[0], &Target[0], m_HashWidth);
-
-    for (size_t j = Iteration; j < m_Length - 1; j++)
+    // The protocol returns one match per endpoint, which
+    // fingerprint tables can not give
+    if (!m_Shards.empty() || m_TableType == TypeFingerprint)
     {
-        length = Reducer.Reduce(&reduced[0], m_Max, &hash[0], j);
-        DoHash((uint8_t*)&reduced[0], length, &hash[0]);
+        std::cerr << "Only a single " << (m_Shards.empty() ? "non fingerprint table" : "shard") << " can be served" << std::endl;
+        return false;
     }
 
-    // Final reduction
-    length = Reducer.Reduce(&reduced[0], m_Max, &hash[0], m_Length - 1);
-
-    // Check end, if it matches, we can perform one full chain to see if we find it
-    size_t index = FindEndpoint(&reduced[0], length);
-    if (index != (size_t)-1)
+    if (m_Threads == 0)
     {
-        return ValidateChain(index, &Target[0]);
+        m_Threads = std::thread::hardware_concurrency();
     }
-    return std::nullopt;
-}
 
-void
-RainbowTable::CrackOneWorker(
-    const size_t ThreadId,
-    const std::vector<uint8_t> Target
-)
-{
-    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset);
+    if (!PrepareLookup())
+    {
+        return false;
+    }
 
-    m_CrackingThreadsRunning++;
+    const int listener = Socket::Listen(Address);
+    if (listener == -1)
+    {
+        return false;
+    }
+    std::cerr << "Serving " << m_Chains << " chains from " << m_Path << " on " << Address << std::endl;
 
-    for (ssize_t i = m_Length - 1 - ThreadId; i >= 0 && !m_Cracked; i -= m_Threads)
+    // Each coordinator connection is answered on its own thread
+    while (true)
     {
-        auto result = CheckIteration(reducer, Target, i);
-        bool cracked = m_Cracked;
-        if (result.has_value() && !cracked && m_Cracked.compare_exchange_strong(cracked, true))
+        const int fd = Socket::Accept(listener);
+        if (fd == -1 && errno == EINTR)
         {
-            m_Cracked = true;
-            m_LastCracked = std::make_tuple(Util::ToHex(&Target[0], Target.size()), result.value());
-            m_CrackedResults.push_back(m_LastCracked);
+            continue;
+        }
+        else if (fd == -1)
+        {
+            std::cerr << "Unable to accept connection: " << strerror(errno) << std::endl;
+            break;
         }
+        std::thread([this, fd]() {
+            ServeConnection(fd);
+            close(fd);
+        }).detach();
     }
 
-    m_CrackingThreadsRunning--;
+    close(listener);
+    return false;
 }
 
-std::optional<std::string>
-RainbowTable::CrackOne(
-    const std::string& Hash
-)
+void
+RainbowTable::ServeConnection(
+    const int Fd
+) const
 {
-    if (Hash.size() != m_HashWidth * 2)
-    {
-        std::cerr << "Invalid length of provided hash: " << Hash.size() << " != " << m_HashWidth * 2 << std::endl;
-        std::cerr << "Hash: '" << Hash << "'" << std::endl;
-        return std::nullopt;
-    }
-
-    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset);
-    auto target = Util::ParseHex(Hash);
-    std::optional<std::string> result;
-
-    // Perform linear check
-    if (m_Threads == 1)
+    RemoteRequest request;
+    while (Socket::RecvAll(Fd, &request, sizeof(request)))
     {
-        for (ssize_t i = m_Length - 1; i >= 0; i--)
+        if (request.magic != kRemoteMagic || request.count > kRemoteMaxItems)
         {
-            result = CheckIteration(reducer, target, i);
-            if (result.has_value())
-            {
-                break;
-            }
+            std::cerr << "Invalid request, closing connection" << std::endl;
+            return;
         }
-    }
-    else
-    {
-        m_ThreadsCompleted = m_Threads;
 
-        // Dispatch the work to the worker threads
-        for (size_t i = 0; i < m_Threads; i++)
+        std::vector<uint8_t> response;
+        if (request.op == RemoteHello)
         {
-            m_DispatchPool->PostTask(
-                dispatch::bind(
-                    &RainbowTable::CrackOneWorker,
-                    this,
-                    i,
-                    target
-                )
-            );
+            TableHeader hdr;
+            const uint64_t chains = m_Chains;
+            GetTableHeader(m_Path, &hdr);
+            response.resize(sizeof(hdr) + sizeof(chains));
+            memcpy(&response[0], &hdr, sizeof(hdr));
+            memcpy(&response[sizeof(hdr)], &chains, sizeof(chains));
         }
-
-        // Wait for at least one thread to start
-        while (m_CrackingThreadsRunning == 0)
+        else if (request.op == RemoteFind)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::vector<char> payload(request.count * m_Max);
+            if (!Socket::RecvAll(Fd, payload.data(), payload.size()))
+            {
+                return;
+            }
+
+            std::vector<std::string> endpoints(request.count);
+            for (size_t i = 0; i < request.count; i++)
+            {
+                endpoints[i].assign(&payload[i * m_Max], m_Max);
+            }
+            const std::vector<size_t> found = FindEndpoints(endpoints);
+            response.resize(found.size() * sizeof(uint64_t));
+            for (size_t i = 0; i < found.size(); i++)
+            {
+                const uint64_t start = found[i];
+                memcpy(&response[i * sizeof(uint64_t)], &start, sizeof(start));
+            }
         }
+        else if (request.op == RemoteValidate)
+        {
+            const size_t itemSize = sizeof(uint64_t) + m_HashWidth;
+            const size_t resultSize = 1 + m_Max;
+            std::vector<uint8_t> payload(request.count * itemSize);
+            if (!Socket::RecvAll(Fd, payload.data(), payload.size()))
+            {
+                return;
+            }
 
-        // Wait for the threads to finish
-        while (m_CrackingThreadsRunning != 0)
+            // Chains are walked in parallel slices. Matches for a hash
+            // arrive together, so once one validates the rest are skipped
+            response.resize(request.count * resultSize, 0);
+            const size_t threads = std::max(std::min(m_Threads, (size_t)request.count), (size_t)1);
+            std::vector<std::thread> workers;
+            for (size_t thread = 0; thread < threads; thread++)
+            {
+                workers.emplace_back([&, thread]() {
+                    const uint8_t* solved = nullptr;
+                    for (size_t i = request.count * thread / threads; i < request.count * (thread + 1) / threads; i++)
+                    {
+                        const uint8_t* const item = &payload[i * itemSize];
+                        const uint8_t* const hash = item + sizeof(uint64_t);
+                        uint8_t* const result = &response[i * resultSize];
+                        result[0] = kRemoteNotFound;
+                        if (solved != nullptr && memcmp(solved, hash, m_HashWidth) == 0)
+                        {
+                            continue;
+                        }
+
+                        uint64_t start;
+                        memcpy(&start, item, sizeof(start));
+                        const auto word = ValidateChain(start, hash);
+                        if (word.has_value())
+                        {
+                            result[0] = word->size();
+                            memcpy(result + 1, word->data(), word->size());
+                            solved = hash;
+                        }
+                    }
+                });
+            }
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+        else
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::cerr << "Unknown request " << request.op << ", closing connection" << std::endl;
+            return;
         }
 
-        // Check if we found the result
-        if (m_Cracked)
+        if (!Socket::SendAll(Fd, response.data(), response.size()))
         {
-            result = std::get<1>(m_LastCracked);
+            return;
         }
     }
-
-    return result;
 }
 
-std::vector<std::tuple<std::string, std::string>>
-RainbowTable::Crack(
-    std::string& Target
+void
+RainbowTable::CrackDistributed(
+    const std::string& Target
 )
 {
-    // Mmap the table
-    if (!MapTable(true))
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
     {
-        std::cerr << "Error mapping the table" << std::endl;
-        return {};
+        return;
     }
 
-    // Check the argument
-    if (!Util::IsHex(Target) && !std::filesystem::exists(Target))
+    std::vector<std::optional<std::string>> results(targets.size());
+    const size_t targetsPerRound = std::max(kDistributedCandidates / m_Length, (size_t)1);
+    std::vector<MergeCandidate> candidates;
+    for (size_t first = 0; first < targets.size(); first += targetsPerRound)
     {
-        std::cerr << "Invalid target hash or file" << std::endl;
-        return {};
-    }
-
-    m_Operation = "Cracking";
+        const size_t count = std::min(targetsPerRound, targets.size() - first) * m_Length;
+        candidates.resize(count);
+        RunCrackWorkers([&](const size_t ThreadId) {
+            MergeCandidatesWorker(ThreadId, &targets, first, &candidates[0], count);
+        });
+
+        // Scatter each candidate to the shard holding its prefix
+        std::vector<std::vector<std::string>> endpoints(m_Shards.size());
+        std::vector<std::vector<size_t>> owners(m_Shards.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t shard = ShardFor(&candidates[i].endpoint[0]);
+            endpoints[shard].emplace_back(&candidates[i].endpoint[0], m_Max);
+            owners[shard].push_back(i);
+        }
 
-    // Index the table for multiple lookups
-    if (!m_IndexDisable)
-    {
-        std::cerr << "Indexing table..";
-        IndexTable();
-        std::cerr << " done." << std::endl;
-    }
+        // Every shard looks up and then validates its share at
+        // the same time, and the results are gathered here
+        std::atomic<bool> failed = false;
+        std::vector<std::thread> threads;
+        for (size_t shard = 0; shard < m_Shards.size(); shard++)
+        {
+            threads.emplace_back([&, shard]() {
+                const RainbowTable& table = *m_Shards[shard];
+                std::vector<size_t> found;
+                if (table.m_Remote != nullptr)
+                {
+                    if (!table.m_Remote->Find(endpoints[shard], m_Max, found))
+                    {
+                        failed = true;
+                        return;
+                    }
+                }
+                else
+                {
+                    found = table.FindEndpoints(endpoints[shard]);
+                }
 
-    if (m_Threads == 0)
-    {
-        m_Threads = std::thread::hardware_concurrency();
-    }
+                // Cheaper matches, nearer the start of their chain, are tried first
+                std::vector<MergeMatch> matches;
+                for (size_t i = 0; i < found.size(); i++)
+                {
+                    if (found[i] != (size_t)-1)
+                    {
+                        const MergeCandidate& candidate = candidates[owners[shard][i]];
+                        matches.push_back({candidate.target, candidate.column, found[i]});
+                    }
+                }
+                std::sort(matches.begin(), matches.end(), [](const MergeMatch& A, const MergeMatch& B) {
+                    return A.target != B.target ? A.target < B.target : A.column < B.column;
+                });
 
-    // Create the dispatch pool
-    if (m_Threads > 1)
-    {
-        m_DispatchPool = dispatch::CreateDispatchPool("pool", m_Threads);
-    }
+                std::vector<std::optional<std::string>> words;
+                if (!table.ValidateMatches(matches, targets, words))
+                {
+                    failed = true;
+                    return;
+                }
 
-    // Figure out if this is a single hash
-    if (Util::IsHex(Target))
-    {
-        auto result = CrackOne(Target);
-        if (result)
-        {
-            std::cout << Target << m_Separator << result.value() << std::endl;
+                std::lock_guard<std::mutex> lock(m_ResultsLock);
+                for (size_t i = 0; i < matches.size(); i++)
+                {
+                    if (words[i].has_value() && !results[matches[i].target].has_value())
+                    {
+                        results[matches[i].target] = words[i];
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
         }
-    }
-    // Check if it is a file
-    else if (std::filesystem::exists(Target))
-    {
-        // Open the input file handle
-        m_HashFileStream = std::ifstream(Target);
 
-        std::string line;
-        while (std::getline(m_HashFileStream, line))
+        if (failed)
         {
-            m_ThreadsCompleted = 0;
-            m_Cracked = false;
-            auto result = CrackOne(line);
-            if (result.has_value())
-            {
-                std::cout << line << m_Separator << result.value() << std::endl;
-            }
+            std::cerr << "Distributed lookup failed, stopping" << std::endl;
+            break;
         }
+        std::cerr << "Searched " << first + count / m_Length << "/" << targets.size() << " targets" << std::endl;
     }
 
-    // Stop the pool
-    if (m_DispatchPool != nullptr)
+    for (size_t i = 0; i < targets.size(); i++)
     {
-        m_DispatchPool->Stop();
-        m_DispatchPool->Wait();
+        if (results[i].has_value())
+        {
+            std::cout << hashes[i] << m_Separator << results[i].value() << std::endl;
+            m_CrackedResults.push_back({hashes[i], results[i].value()});
+        }
     }
-
-    return std::move(m_CrackedResults);
 }
 
-std::optional<std::string>
-RainbowTable::ValidateChain(
-    const size_t ChainIndex,
-    const uint8_t* Target
+bool
+RainbowTable::LoadTargets(
+    const std::string& Target,
+    std::vector<std::string>& Hashes,
+    std::vector<std::vector<uint8_t>>& Targets
 ) const
 {
-    size_t length;
-    std::vector<uint8_t> hash(m_HashWidth);
-    std::vector<char> reduced(m_Max);
-    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset);
-#ifdef BIGINT
-    mpz_class counter = WordGenerator::WordLengthIndex(m_Min, m_Charset);
-#else
-    uint64_t counter = WordGenerator::WordLengthIndex64(m_Min, m_Charset);
-#endif
-    counter += ChainIndex;
-
-    auto start = WordGenerator::GenerateWord(counter,m_Charset);
-    length = start.size();
-    memcpy(&reduced[0], start.c_str(), length);
+    // A single hash or a file of hashes
+    if (Util::IsHex(Target))
+    {
+        Hashes.push_back(Target);
+    }
+    else
+    {
+        std::ifstream hashStream(Target);
+        std::string line;
+        while (std::getline(hashStream, line))
+        {
+            Hashes.push_back(line);
+        }
+    }
 
-    for (size_t i = 0; i < m_Length; i++)
+    for (auto it = Hashes.begin(); it != Hashes.end();)
     {
-        DoHash((uint8_t*)&reduced[0], length, &hash[0]);
-        if (memcmp(Target, &hash[0], m_HashWidth) == 0)
+        // Already found by an earlier stage
+        if (IsSolved(*it))
         {
-            return std::string(&reduced[0], &reduced[length]);
+            it = Hashes.erase(it);
+            continue;
         }
-        length = reducer.Reduce(&reduced[0], m_Max, &hash[0], i);
+        if (it->size() != m_HashWidth * 2 || !Util::IsHex(*it))
+        {
+            std::cerr << "Skipping invalid hash: '" << *it << "'" << std::endl;
+            it = Hashes.erase(it);
+            continue;
+        }
+        Targets.push_back(Util::ParseHex(*it));
+        it++;
     }
-    return {};
-}
 
-RainbowTable::~RainbowTable(
-    void
-)
-{
-    Reset();
+    if (Targets.empty() || Targets.size() > std::numeric_limits<uint32_t>::max())
+    {
+        std::cerr << "Invalid number of targets: " << Targets.size() << std::endl;
+        return false;
+    }
+    return true;
 }
 
 void
-RainbowTable::Reset(
-    void
+RainbowTable::RunCrackWorkers(
+    const std::function<void(const size_t ThreadId)>& Worker
 )
 {
-    UnmapTable();
+    if (m_DispatchPool == nullptr)
+    {
+        m_CrackingThreadsRunning = 1;
+        Worker(0);
+        return;
+    }
 
-    m_Path.clear();
-    m_PathLoaded = false;
-    m_Algorithm = HashAlgorithmUndefined;
-    m_Min = 0;
-    m_Max = 0;
-    m_Length = 0;
-    m_Blocksize = 1024;
-    m_Count = 0;
-    m_Threads = 0;
-    m_Charset.clear();
-    m_HashWidth = 0;
-    m_ChainWidth = 0;
-    m_Chains = 0;
-    m_TableType = TypeCompressed;
-    // For building
-    m_StartingChains = 0;
-    m_WriteHandle = nullptr;
-    m_NextWriteBlock = 0;
-    m_WriteCache.clear();
-    if (m_DispatchPool != nullptr)
+    // Workers decrement the count as they finish
+    m_CrackingThreadsRunning = m_Threads;
+    for (size_t i = 0; i < m_Threads; i++)
     {
-        m_DispatchPool->Stop();
-        m_DispatchPool->Wait();
-        m_DispatchPool = nullptr;
+        m_DispatchPool->PostTask(dispatch::bind(Worker, i));
     }
-    m_ThreadsCompleted = 0;
-}
 
-#ifdef __APPLE__
-int
-SortCompareEndpoints(
-    void* Arguments,
-    const void* Comp1,
-    const void* Comp2
-)
-{
-    return memcmp((uint8_t*)Comp1 + sizeof(rowindex_t), (uint8_t*)Comp2 + sizeof(rowindex_t), (size_t)Arguments);
+    while (m_CrackingThreadsRunning != 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
 }
-#else
-int
-SortCompareEndpoints(
-    const void* Comp1,
-    const void* Comp2,
-    void* Arguments
+
+void
+RainbowTable::MergeCandidatesWorker(
+    const size_t ThreadId,
+    const std::vector<std::vector<uint8_t>>* Targets,
+    const size_t First,
+    MergeCandidate* Candidates,
+    const size_t Count
 )
 {
-    return memcmp((uint8_t*)Comp1 + sizeof(rowindex_t), (uint8_t*)Comp2 + sizeof(rowindex_t), (size_t)Arguments);
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+
+    // Interleave candidates between threads so that the
+    // expensive early columns are shared evenly
+    for (size_t i = ThreadId; i < Count; i += m_Threads)
+    {
+        MergeCandidate& candidate = Candidates[i];
+        candidate.target = First + i / m_Length;
+        candidate.column = i % m_Length;
+        memset(&candidate.endpoint[0], 0, sizeof(candidate.endpoint));
+        ComputeEndpoint(reducer, &(*Targets)[candidate.target][0], candidate.column, &candidate.endpoint[0]);
+    }
+
+    m_CrackingThreadsRunning--;
 }
-#endif
 
-int
-SortCompareStartpoints(
-    const void* Comp1,
-    const void* Comp2
+void
+RainbowTable::MergeValidateWorker(
+    const size_t ThreadId,
+    const std::vector<MergeMatch>* Matches,
+    const std::vector<std::vector<uint8_t>>* Targets,
+    std::vector<std::optional<std::string>>* Results
 )
 {
-    return *((rowindex_t*)Comp1) - *((rowindex_t*)Comp2);
+    // Each target is owned by a single thread so
+    // results can be written without locking
+    for (const MergeMatch& match : *Matches)
+    {
+        if (match.target % m_Threads != ThreadId || (*Results)[match.target].has_value())
+        {
+            continue;
+        }
+        (*Results)[match.target] = ValidateChain(match.start, &(*Targets)[match.target][0]);
+    }
+
+    m_CrackingThreadsRunning--;
 }
 
 void
-RainbowTable::SortStartpoints(
-    void
+RainbowTable::CrackMergeJoin(
+    const std::string& Target
 )
 {
-    if (!MapTable(false))
+    if (m_TableType != TypeUncompressed)
     {
-        std::cerr << "Error mapping table for sort"  << std::endl;
+        std::cerr << "Merge join cracking requires a sorted uncompressed table" << std::endl;
         return;
     }
 
-    uint8_t* start = m_MappedTable + sizeof(TableHeader);
-    if (m_TableType == TypeCompressed)
+    // Load every target up front
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
     {
-        std::cerr << "Unable to sort compressed tables by start point" << std::endl;
         return;
     }
 
-    qsort(start, GetCount(), GetChainWidth(), SortCompareStartpoints);
-}
+    const size_t width = m_Max;
+    auto compare = [width](const MergeCandidate& A, const MergeCandidate& B) { return memcmp(&A.endpoint[0], &B.endpoint[0], width) < 0; };
 
-void
-RainbowTable::SortTable(
-    void
-)
-{
-    if (!MapTable(false))
+    // Compute the candidates for a group of targets at a time,
+    // sort them and spill each group to a temporary run file
+    std::vector<std::filesystem::path> runs;
+    const size_t targetsPerRun = std::max(kMergeRunCandidates / m_Length, (size_t)1);
+    std::vector<MergeCandidate> candidates;
+    for (size_t first = 0; first < targets.size(); first += targetsPerRun)
     {
-        std::cerr << "Error mapping table for sort"  << std::endl;
-        return;
+        const size_t count = std::min(targetsPerRun, targets.size() - first) * m_Length;
+        candidates.resize(count);
+        RunCrackWorkers([&](const size_t ThreadId) {
+            MergeCandidatesWorker(ThreadId, &targets, first, &candidates[0], count);
+        });
+        std::sort(candidates.begin(), candidates.end(), compare);
+
+        std::filesystem::path run = std::filesystem::temp_directory_path();
+        run /= "simdrainbowcrack." + std::to_string(getpid()) + ".run" + std::to_string(runs.size());
+        FILE* fh = fopen(run.c_str(), "w");
+        if (fh == nullptr || fwrite(&candidates[0], sizeof(MergeCandidate), count, fh) != count)
+        {
+            std::cerr << "Error writing candidate run: " << run << std::endl;
+            if (fh != nullptr)
+            {
+                fclose(fh);
+            }
+            for (auto& path : runs)
+            {
+                std::filesystem::remove(path);
+            }
+            std::filesystem::remove(run);
+            return;
+        }
+        fclose(fh);
+        runs.push_back(run);
+        std::cerr << "Sorted candidates for " << first + count / m_Length << "/" << targets.size() << " targets" << std::endl;
     }
+    candidates.clear();
+    candidates.shrink_to_fit();
+
+    // Merge the runs and join them against the table in a single
+    // sequential pass. Large read buffers keep the disks streaming
+    constexpr size_t kRunBufferSize = 4 * 1024 * 1024;
+    std::vector<FILE*> handles;
+    std::vector<MergeCandidate> heads(runs.size());
+    auto greater = [&heads, &compare](const size_t A, const size_t B) { return compare(heads[B], heads[A]); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> queue(greater);
+    auto removeRuns = [&]() {
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            if (i < handles.size() && handles[i] != nullptr)
+            {
+                fclose(handles[i]);
+            }
+            std::filesystem::remove(runs[i]);
+        }
+    };
 
-    uint8_t* start = m_MappedTable + sizeof(TableHeader);
-    if (m_TableType == TypeUncompressed)
+    // A run that cannot be read in full would silently drop its
+    // candidates, so reads only stop early at the end of a run
+    bool failed = false;
+    for (size_t i = 0; i < runs.size() && !failed; i++)
     {
-#ifdef __APPLE__
-        qsort_r(start, GetCount(), GetChainWidth(), (void*)m_Max, SortCompareEndpoints);
-#else
-        qsort_r(start, GetCount(), GetChainWidth(), SortCompareEndpoints, (void*)m_Max);
-#endif
+        handles.push_back(fopen(runs[i].c_str(), "r"));
+        if (handles.back() == nullptr)
+        {
+            failed = true;
+            break;
+        }
+        setvbuf(handles.back(), nullptr, _IOFBF, kRunBufferSize);
+        if (fread(&heads[i], sizeof(MergeCandidate), 1, handles.back()) == 1)
+        {
+            queue.push(i);
+        }
+        failed = ferror(handles.back()) != 0;
     }
-    else
+
+    if (failed)
     {
-        qsort(start, GetCount(), GetChainWidth(), SortCompareStartpoints);
+        std::cerr << "Error reading candidate run: " << runs[handles.size() - 1] << std::endl;
+        removeRuns();
+        return;
     }
-}
 
-void
-RainbowTable::RemoveStartpoints(
-    void
-)
-{
-    // Ensure the table is mapped writable
-    if (!MapTable(false))
+    if (!MapTable(true))
     {
-        std::cerr << "Unable to map the table" << std::endl;
+        std::cerr << "Error mapping the table" << std::endl;
+        removeRuns();
         return;
     }
+    madvise(m_MappedTable, m_MappedFileSize, MADV_SEQUENTIAL);
 
-    // Change the table type in the header
-    (*(TableHeader*)m_MappedTable).type = TypeCompressed;
-
-    // Loop through the chains
-    uint8_t* tableBase = m_MappedTable + sizeof(TableHeader);
-    uint8_t* writepointer = tableBase;
-    for (size_t chain = 0; chain < GetCount(); chain++)
+    std::vector<MergeMatch> matches;
+    size_t record = 0;
+    while (!queue.empty() && record < m_Chains)
     {
-        uint8_t* endpoint = tableBase + (chain * ChainWidthForType(TypeUncompressed, GetMax())) + sizeof(rowindex_t);
-        memmove(writepointer, endpoint, GetMax());
-        writepointer += GetMax();
+        const size_t run = queue.top();
+        const MergeCandidate& candidate = heads[run];
+        const int cmp = memcmp(GetEndpointAt(record), &candidate.endpoint[0], m_Max);
+        if (cmp < 0)
+        {
+            record++;
+            continue;
+        }
+
+        // Pair the candidate with every chain sharing its endpoint. The
+        // table position is kept as the next candidate may be the same
+        for (size_t next = record; cmp == 0 && next < m_Chains && memcmp(GetEndpointAt(next), &candidate.endpoint[0], m_Max) == 0; next++)
+        {
+            matches.push_back({candidate.target, candidate.column, *(rowindex_t*)GetRecordAt(next)});
+        }
+
+        queue.pop();
+        if (fread(&heads[run], sizeof(MergeCandidate), 1, handles[run]) == 1)
+        {
+            queue.push(run);
+        }
+        else if (ferror(handles[run]) != 0)
+        {
+            std::cerr << "Error reading candidate run: " << runs[run] << std::endl;
+            removeRuns();
+            return;
+        }
     }
+    removeRuns();
 
-    // Truncate the file
-    if (!UnmapTable())
+    std::cerr << "Validating " << matches.size() << " candidate chains" << std::endl;
+
+    // Cheaper matches, nearer the start of their chain, are tried first
+    std::sort(matches.begin(), matches.end(), [](const MergeMatch& A, const MergeMatch& B) {
+        return A.target != B.target ? A.target < B.target : A.column < B.column;
+    });
+
+    std::vector<std::optional<std::string>> results(targets.size());
+    RunCrackWorkers([&](const size_t ThreadId) {
+        MergeValidateWorker(ThreadId, &matches, &targets, &results);
+    });
+
+    for (size_t i = 0; i < targets.size(); i++)
     {
-        std::cerr << "Error unmapping table after removing start points" << std::endl;
-        return;
+        if (results[i].has_value())
+        {
+            std::cout << hashes[i] << m_Separator << results[i].value() << std::endl;
+            m_CrackedResults.push_back({hashes[i], results[i].value()});
+        }
     }
+}
+
+void
+RainbowTable::TableScanWorker(
+    const size_t ThreadId,
+    const TargetSet* Targets,
+    std::vector<std::optional<std::string>>* Results
+)
+{
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+    SimdHashBufferFixed<MAX_LENGTH> words;
+    std::array<uint8_t, MAX_HASH_SIZE * MAX_LANES> hashes;
+    const size_t hashWidth = m_HashWidth;
+    const size_t lanes = SimdLanes();
+
+    // Threads take turns to regenerate one group of chains per lane
+    for (size_t first = ThreadId * lanes; first < m_Chains && m_TargetsRemaining > 0; first += m_Threads * lanes)
+    {
+        // Spare lanes at the end of the table repeat the last chain
+        const size_t count = std::min(lanes, m_Chains - first);
+        for (size_t i = 0; i < lanes; i++)
+        {
+            const size_t chain = first + std::min(i, count - 1);
+            const rowindex_t index = m_TableType == TypeUncompressed ? *(rowindex_t*)GetRecordAt(chain) : chain;
+#ifdef BIGINT
+            mpz_class counter = CalculateLowerBound() + index;
+#else
+            uint64_t counter = CalculateLowerBound() + index;
+#endif
+            const size_t length = WordGenerator::GenerateWord((char*)words[i], m_Max, counter, m_Charset);
+            words.SetLength(i, length);
+        }
+
+        for (size_t i = 0; i < m_Length; i++)
+        {
+            SimdHashOptimized(
+                m_Algorithm,
+                words.GetLengths(),
+                words.ConstBuffers(),
+                &hashes[0]
+            );
+
+            for (size_t h = 0; h < lanes; h++)
+            {
+                const uint8_t* hash = &hashes[h * hashWidth];
+
+                // Every hash in the chain is checked so a hit is
+                // the plaintext itself and needs no validation
+                const size_t target = h < count ? Targets->Find(hash) : (size_t)-1;
+                if (target != (size_t)-1)
+                {
+                    std::lock_guard<std::mutex> lock(m_ResultsLock);
+                    if (!(*Results)[target].has_value())
+                    {
+                        (*Results)[target] = std::string((char*)words[h], words.GetLength(h));
+                        m_TargetsRemaining--;
+                    }
+                }
 
-    size_t newSize = sizeof(TableHeader) + (GetCount() * GetMax());
-    auto result = truncate(m_Path.c_str(), newSize);
-    if (result != 0)
-    {
-        std::cerr << "Error truncating file" << std::endl;
-        return;
+                const size_t length = reducer.Reduce((char*)words[h], m_Max, hash, i);
+                words.SetLength(h, length);
+            }
+        }
     }
+
+    m_CrackingThreadsRunning--;
 }
 
 void
-RainbowTable::ChangeType(
-    const std::filesystem::path& Destination,
-    const TableType Type
+RainbowTable::CrackTableScan(
+    const std::string& Target
 )
 {
-    FILE* fhw;
-    TableHeader hdr;
+    // Start points are stored in uncompressed tables and
+    // implied by position in compressed tables
+    if (m_TableType != TypeUncompressed && m_TableType != TypeCompressed)
+    {
+        std::cerr << "Table scan cracking requires a compressed or uncompressed table" << std::endl;
+        return;
+    }
 
-    if (m_TableType == Type)
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
     {
-        std::cerr << "Won't convert to same type" << std::endl;
         return;
     }
 
-    // Output some basic information about the
-    // current table
-    std::cout << "Table type: " << GetType() << std::endl;
-    std::cout << "Chain width: " << GetChainWidth() << std::endl;
-    std::cout << "Exporting " << m_Chains << " chains" << std::endl;
+    TargetSet targetSet;
+    targetSet.Init(targets, m_HashWidth);
+    m_TargetsRemaining = targets.size();
 
-    // If we are converting to a compressed file we need to do
-    // it in two stages. We need a full copy of the file so that
-    // we can then sort it by start points. Then we remove all 
-    // startpoints from the file
-    if (Type == TypeCompressed)
+    std::cerr << "Scanning " << m_Chains << " chains for " << targets.size() << " targets" << std::endl;
+
+    std::vector<std::optional<std::string>> results(targets.size());
+    RunCrackWorkers([&](const size_t ThreadId) {
+        TableScanWorker(ThreadId, &targetSet, &results);
+    });
+
+    for (size_t i = 0; i < targets.size(); i++)
     {
-        if (!std::filesystem::copy_file(m_Path, Destination, std::filesystem::copy_options::overwrite_existing))
+        if (results[i].has_value())
         {
-            std::cerr << "Error copying file for conversion" << std::endl;
-            return;
+            std::cout << hashes[i] << m_Separator << results[i].value() << std::endl;
+            m_CrackedResults.push_back({hashes[i], results[i].value()});
         }
     }
-    else
-    {
-        // Map the current table to memory
-        if (!MapTable(true))
-        {
-            std::cerr << "Error mapping table"  << std::endl;
-            return;
-        }
+}
 
-        // Copy the existing header but change the type to uncompressed
-        hdr = *((TableHeader*)m_MappedTable);
-        hdr.type = TypeUncompressed;
+void
+RainbowTable::BruteForceWorker(
+    const size_t ThreadId,
+    const TargetSet* Targets,
+    const std::vector<uint64_t>* Bounds,
+    const uint64_t Last,
+    const std::chrono::steady_clock::time_point Deadline,
+    std::vector<std::optional<std::string>>* Results
+)
+{
+    SimdHashBufferFixed<MAX_LENGTH> words;
+    std::array<uint8_t, MAX_HASH_SIZE * MAX_LANES> hashes;
+    const size_t hashWidth = m_HashWidth;
+    const size_t lanes = SimdLanes();
+    const uint64_t chunk = lanes * 4096;
+    const std::vector<uint64_t>& bounds = *Bounds;
 
-        // Open the destination for writing
-        fhw = fopen(Destination.c_str(), "w");
-        if (fhw == nullptr)
+    // Chunks are handed out in order so words are tried from
+    // shortest to longest even when stopped by the deadline
+    while (m_TargetsRemaining > 0 && std::chrono::steady_clock::now() < Deadline)
+    {
+        const uint64_t first = m_BruteForceNext.fetch_add(chunk);
+        if (first >= Last)
         {
-            std::cerr << "Error opening desination table for write: " << Destination << std::endl;
-            return;
+            break;
         }
 
-        // Write the header
-        fwrite(&hdr, sizeof(hdr), 1, fhw);
+        const uint64_t end = std::min(first + chunk, Last);
+        for (uint64_t counter = first; counter < end; counter += lanes)
+        {
+            // Spare lanes at the end of the keyspace repeat the last word
+            const size_t count = std::min((uint64_t)lanes, end - counter);
+            for (size_t i = 0; i < lanes; i++)
+            {
+                const uint64_t index = counter + std::min(i, count - 1);
+                size_t length = 0;
+                while (index >= bounds[length + 1])
+                {
+                    length++;
+                }
+                WordGenerator::GenerateWordFixed((char*)words[i], length, index - bounds[length], m_Charset);
+                words.SetLength(i, length);
+            }
 
-        // Pointer to track the next read target
-        uint8_t* next = m_MappedTable + sizeof(TableHeader);
+            SimdHashOptimized(
+                m_Algorithm,
+                words.GetLengths(),
+                words.ConstBuffers(),
+                &hashes[0]
+            );
 
-        // Loop through and write each index followed by the next endpoint
-        for (rowindex_t index = 0; index < m_Chains; index++, next += GetChainWidth())
-        {
-            fwrite(&index, sizeof(rowindex_t), 1, fhw);
-            fwrite(next, sizeof(char), m_Max, fhw);
+            for (size_t h = 0; h < count; h++)
+            {
+                const size_t target = Targets->Find(&hashes[h * hashWidth]);
+                if (target != (size_t)-1)
+                {
+                    std::lock_guard<std::mutex> lock(m_ResultsLock);
+                    if (!(*Results)[target].has_value())
+                    {
+                        (*Results)[target] = std::string((char*)words[h], words.GetLength(h));
+                        m_TargetsRemaining--;
+                    }
+                }
+            }
         }
-        fclose(fhw);
     }
 
-    // Perform sort and cleanup work on the new table
-    RainbowTable newtable;
-    newtable.SetPath(Destination);
+    m_CrackingThreadsRunning--;
+}
 
-    if (!newtable.ValidTable())
+bool
+RainbowTable::CrackBruteForce(
+    const std::string& Target
+)
+{
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
     {
-        std::cerr << "Decompressed table does not seem valid" << std::endl;
-        return;
+        // Leave the table stage to report the targets
+        return true;
     }
 
-    if (!newtable.LoadTable())
+    // Words are numbered from the empty word upwards by length and
+    // these are the index of the first word of each length. Keyspaces
+    // past 64 bits are out of reach anyway
+    size_t length = std::min(m_BruteForceLength == 0 ? m_Max : m_BruteForceLength, (size_t)MAX_LENGTH);
+    std::vector<uint64_t> bounds;
+    for (size_t i = 0; i <= length + 1; i++)
     {
-        std::cerr << "Error loading new table" << std::endl;
-        return;
+        const mpz_class bound = WordGenerator::WordLengthIndex(i, m_Charset);
+        if (!bound.fits_ulong_p())
+        {
+            length = i - 2;
+            break;
+        }
+        bounds.push_back(bound.get_ui());
     }
-
-    std::cout << "Sorting " << newtable.GetCount() << " chains" << std::endl;
-
-    if (m_TableType == TypeCompressed)
+    bounds.resize(length + 2);
+    uint64_t last = bounds.back();
+    if (m_BruteForceLimit > 0)
     {
-        newtable.SortTable();
+        last = std::min(last, m_BruteForceLimit);
     }
-    else
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = m_BruteForceMs > 0 ? start + std::chrono::milliseconds(m_BruteForceMs) : std::chrono::steady_clock::time_point::max();
+
+    TargetSet targetSet;
+    targetSet.Init(targets, m_HashWidth);
+    m_TargetsRemaining = targets.size();
+    m_BruteForceNext = 0;
+
+    std::vector<std::optional<std::string>> results(targets.size());
+    RunCrackWorkers([&](const size_t ThreadId) {
+        BruteForceWorker(ThreadId, &targetSet, &bounds, last, deadline, &results);
+    });
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cerr << "Brute forced " << std::min(m_BruteForceNext.load(), last) << " words up to length " << length;
+    std::cerr << " in " << elapsed.count() << "ms, found " << targets.size() - m_TargetsRemaining << " of " << targets.size() << std::endl;
+
+    for (size_t i = 0; i < targets.size(); i++)
     {
-        // Sort the table by startpoint
-        newtable.SortStartpoints();
-        // Remove all startpoints and truncate
-        newtable.RemoveStartpoints();
+        if (results[i].has_value())
+        {
+            std::cout << hashes[i] << m_Separator << results[i].value() << std::endl;
+            m_CrackedResults.push_back({hashes[i], results[i].value()});
+            MarkSolved(hashes[i]);
+        }
     }
+
+    return m_TargetsRemaining > 0;
 }
 
-/* static */ const Chain
-RainbowTable::GetChain(
-    const std::filesystem::path& Path,
-    const size_t Index
+void
+RainbowTable::ScheduledWorker(
+    const size_t ThreadId,
+    const std::vector<std::string>* Hashes,
+    const std::vector<std::vector<uint8_t>>* Targets,
+    std::vector<std::atomic<bool>>* Solved
 )
 {
-    TableHeader hdr;
-    GetTableHeader(Path, &hdr);
-
-    std::string charset(&hdr.charset[0], &hdr.charset[hdr.charsetlen]);
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+    const size_t targets = Targets->size();
+    const size_t items = targets * m_Length;
+
+    // Work item k is column (m_Length - 1 - k / targets) of target
+    // (k % targets). Columns nearer the chain end need fewer hashes
+    // so taking items in order runs the cheapest work of every target
+    // first, and idle threads always take the next item
+    for (size_t item = m_NextWorkItem++; item < items && m_TargetsRemaining > 0; item = m_NextWorkItem++)
+    {
+        const size_t target = item % targets;
+        const size_t column = m_Length - 1 - item / targets;
+        if ((*Solved)[target])
+        {
+            continue;
+        }
 
-    Chain chain;
-    chain.SetIndex(Index);
-    chain.SetLength(hdr.length);
+        auto result = CheckIteration(reducer, (*Targets)[target], column);
+        if (result.has_value())
+        {
+            std::lock_guard<std::mutex> lock(m_ResultsLock);
+            if (!(*Solved)[target])
+            {
+                (*Solved)[target] = true;
+                m_TargetsRemaining--;
+                std::cout << (*Hashes)[target] << m_Separator << result.value() << std::endl;
+                m_CrackedResults.push_back({(*Hashes)[target], result.value()});
+            }
+        }
+    }
 
-    FILE* fh = fopen(Path.c_str(), "r");
-    fseek(fh, sizeof(TableHeader), SEEK_SET);
-    fseek(fh, ChainWidthForType((TableType)hdr.type, hdr.max) * Index, SEEK_CUR);
+    m_CrackingThreadsRunning--;
+}
 
-    rowindex_t start = Index;
-    if (hdr.type == (uint8_t)TypeUncompressed)
+void
+RainbowTable::CrackScheduled(
+    const std::string& Target
+)
+{
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
     {
-        fread(&start, sizeof(rowindex_t), 1, fh);
+        return;
     }
-    mpz_class lowerbound = WordGenerator::WordLengthIndex(hdr.min, charset);
-    static_assert(sizeof(rowindex_t) == 4 || (sizeof(unsigned long int) == sizeof(rowindex_t)));
-    auto word = WordGenerator::GenerateWord(lowerbound + (unsigned long int)start, charset);
-    chain.SetStart(word);
 
-    std::string endpoint;
-    endpoint.resize(hdr.max);
-    fread(&endpoint[0], sizeof(char), hdr.max, fh);
-    // Trim nulls
-    endpoint.resize(strlen(endpoint.c_str()));
-    chain.SetEnd(endpoint);
+    std::vector<std::atomic<bool>> solved(targets.size());
+    m_TargetsRemaining = targets.size();
+    m_NextWorkItem = 0;
 
-    return chain;
+    RunCrackWorkers([&](const size_t ThreadId) {
+        ScheduledWorker(ThreadId, &hashes, &targets, &solved);
+    });
 }
 
-/* static */ const Chain
-RainbowTable::ComputeChain(
-    const size_t Index,
-    const size_t Min,
-    const size_t Max,
-    const size_t Length,
-    const HashAlgorithm Algorithm,
-    const std::string& Charset
+void
+RainbowTable::PipelineWorker(
+    const size_t ThreadId,
+    const std::vector<std::string>* Hashes,
+    const std::vector<std::vector<uint8_t>>* Targets,
+    std::vector<std::atomic<bool>>* Solved
 )
 {
-    mpz_class counter;
-    Chain chain;
-    size_t hashLength;
-    std::string start;
-
-    hashLength = GetHashWidth(Algorithm);
-
-    chain.SetIndex(Index);
-    chain.SetLength(Length);
+    HybridReducer reducer(m_Min, m_Max, m_HashWidth, m_Charset, m_TableIndex);
+    const size_t targets = Targets->size();
+    const size_t items = targets * m_Length;
+    std::vector<MergeCandidate> candidates;
+    std::vector<MergeMatch> matches;
+
+    // Every worker runs whichever stage has work, preferring the later
+    // stages so that queued work drains. Computing endpoints issues the
+    // readahead for their lookups, which are held back until enough are
+    // queued for the reads to have completed
+    while (true)
+    {
+        size_t first = items;
+        bool idle = false;
+        {
+            std::lock_guard<std::mutex> lock(m_PipelineLock);
+            const bool computing = m_NextWorkItem < items && m_TargetsRemaining > 0;
+            if (!m_VerifyQueue.empty())
+            {
+                const size_t count = std::min(kPipelineBatch, m_VerifyQueue.size());
+                matches.assign(m_VerifyQueue.begin(), m_VerifyQueue.begin() + count);
+                m_VerifyQueue.erase(m_VerifyQueue.begin(), m_VerifyQueue.begin() + count);
+            }
+            else if (m_LookupQueue.size() >= kPipelineDepth || (!computing && !m_LookupQueue.empty()))
+            {
+                const size_t count = std::min(kPipelineBatch, m_LookupQueue.size());
+                candidates.assign(m_LookupQueue.begin(), m_LookupQueue.begin() + count);
+                m_LookupQueue.erase(m_LookupQueue.begin(), m_LookupQueue.begin() + count);
+            }
+            else if (computing)
+            {
+                first = m_NextWorkItem;
+                m_NextWorkItem = std::min(first + kPipelineBatch, items);
+            }
+            // Only busy workers can queue more work
+            else if (m_PipelineBusy == 0)
+            {
+                break;
+            }
+            else
+            {
+                idle = true;
+            }
+            if (!idle)
+            {
+                m_PipelineBusy++;
+            }
+        }
 
-    counter = WordGenerator::WordLengthIndex(Min, Charset);
-    counter += Index;
+        // Wait for the busy workers without holding the lock
+        if (idle)
+        {
+            std::this_thread::yield();
+            continue;
+        }
 
-    start = WordGenerator::GenerateWord(counter, Charset);
-    chain.SetStart(start);
+        if (!matches.empty())
+        {
+            // Verification
+            for (const auto& match : matches)
+            {
+                if ((*Solved)[match.target])
+                {
+                    continue;
+                }
+                auto result = ValidateChain(match.start, &(*Targets)[match.target][0]);
+                if (result.has_value())
+                {
+                    std::lock_guard<std::mutex> lock(m_ResultsLock);
+                    if (!(*Solved)[match.target])
+                    {
+                        (*Solved)[match.target] = true;
+                        m_TargetsRemaining--;
+                        std::cout << (*Hashes)[match.target] << m_Separator << result.value() << std::endl;
+                        m_CrackedResults.push_back({(*Hashes)[match.target], result.value()});
+                    }
+                }
+            }
+            matches.clear();
+        }
+        else if (!candidates.empty())
+        {
+            // Lookup. Fingerprint tables have a candidate chain for
+            // every record sharing the fingerprint
+            for (const auto& candidate : candidates)
+            {
+                if ((*Solved)[candidate.target])
+                {
+                    continue;
+                }
+                const size_t length = strnlen(candidate.endpoint, m_Max);
+                for (const size_t index : FindCandidates(candidate.endpoint, length))
+                {
+                    matches.push_back({candidate.target, candidate.column, index});
+                }
+            }
+            candidates.clear();
+        }
+        else
+        {
+            // Endpoint computation, cheapest columns first
+            const size_t last = std::min(first + kPipelineBatch, items);
+            for (size_t item = first; item < last; item++)
+            {
+                MergeCandidate candidate;
+                candidate.target = item % targets;
+                candidate.column = m_Length - 1 - item / targets;
+                if ((*Solved)[candidate.target])
+                {
+                    continue;
+                }
+                ComputeEndpoint(reducer, &(*Targets)[candidate.target][0], candidate.column, candidate.endpoint);
+                if (m_Readahead)
+                {
+                    ReadaheadEndpoint(candidate.endpoint);
+                }
+                candidates.push_back(candidate);
+            }
+        }
 
-    HybridReducer reducer(Min, Max, hashLength, Charset);
+        std::lock_guard<std::mutex> lock(m_PipelineLock);
+        if (!matches.empty())
+        {
+            m_VerifyQueue.insert(m_VerifyQueue.end(), matches.begin(), matches.end());
+            matches.clear();
+        }
+        if (!candidates.empty())
+        {
+            m_LookupQueue.insert(m_LookupQueue.end(), candidates.begin(), candidates.end());
+            candidates.clear();
+        }
+        m_PipelineBusy--;
+    }
 
-    std::vector<uint8_t> hash(hashLength);
-    std::vector<char> reduced(Max);
-    size_t reducedLength = start.size();
+    m_CrackingThreadsRunning--;
+}
 
-    memcpy(&reduced[0], start.c_str(), reducedLength);
+void
+RainbowTable::CrackPipelined(
+    const std::string& Target
+)
+{
+    std::vector<std::string> hashes;
+    std::vector<std::vector<uint8_t>> targets;
+    if (!LoadTargets(Target, hashes, targets))
+    {
+        return;
+    }
 
-    for (size_t i = 0; i < Length; i++)
+    std::vector<std::atomic<bool>> solved(targets.size());
+    m_TargetsRemaining = targets.size();
+    m_NextWorkItem = 0;
+    m_LookupQueue.clear();
+    m_VerifyQueue.clear();
+    m_PipelineBusy = 0;
+
+    // Tables that stay in the page cache gain nothing from
+    // readahead and would only pay for the system calls
+    // Split tables are only mapped by their shards
+    const size_t memory = sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    size_t size = m_MappedFileSize;
+    for (const auto& shard : m_Shards)
     {
-        DoHash((uint8_t*)&reduced[0], reducedLength, &hash[0], Algorithm);
-        reducedLength = reducer.Reduce(&reduced[0], Max, &hash[0], i);
+        size += shard->m_MappedFileSize;
     }
+    m_Readahead = size > memory / 2;
 
-    chain.SetEnd(std::string(&reduced[0], &reduced[reducedLength]));
-    return chain;
+    RunCrackWorkers([&](const size_t ThreadId) {
+        PipelineWorker(ThreadId, &hashes, &targets, &solved);
+    });
 }
@@ -9,27 +9,45 @@
 #ifndef RainbowTable_hpp
 #define RainbowTable_hpp
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <limits>
 #include <map>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 
 #include "DispatchQueue.hpp"
 #include "simdhash.h"
 
 #include "Chain.hpp"
 #include "Common.hpp"
+#include "EndpointKey.hpp"
+#include "Filter.hpp"
+#include "HyperLogLog.hpp"
+#include "LearnedIndex.hpp"
+#include "Probability.hpp"
 #include "Reduce.hpp"
+#include "RemoteShard.hpp"
+#include "TableStorage.hpp"
+#include "TargetSet.hpp"
 
 typedef enum _TableType
 {
     TypeUncompressed,
     TypeCompressed,
+    TypeFingerprint,
+    TypeDelta,
+    TypeEytzinger,
+    TypeColumnar,
+    // Not stored on disk, keep last
     TypeInvalid
 } TableType;
 
@@ -43,12 +61,124 @@ typedef struct  __attribute__((__packed__)) _TableHeader
     uint8_t  min;
     uint8_t  max;
     uint8_t  charsetlen;
-    uint64_t length;
+    uint32_t length;
+    // The fields below were previously the upper half of
+    // a 64-bit length so are always zero in older tables.
+    // Only two bits were originally reserved for the type
+    // so newer types store the remaining bits in typeext
+    uint8_t  typeext;
+    // Tables in a family share parameters but reduce differently
+    uint8_t  tableindex;
+    uint8_t  reserved[2];
     char     charset[128];
 } TableHeader;
 
+static_assert(sizeof(TableHeader) == 144);
+
+static inline TableType
+GetHeaderType(
+    const TableHeader& Header
+)
+{
+    return (TableType)(Header.type | (Header.typeext << 2));
+}
+
+static inline void
+SetHeaderType(
+    TableHeader& Header,
+    const TableType Type
+)
+{
+    Header.type = Type & 0x3;
+    Header.typeext = Type >> 2;
+}
+
+// Packed table types do not have a fixed byte width per chain.
+// Their data starts with this header describing the layout
+typedef struct  __attribute__((__packed__)) _PackedHeader
+{
+    uint64_t count;
+    uint8_t  keybits;
+    uint8_t  indexbits;
+    uint16_t blocksize;
+    uint32_t reserved;
+} PackedHeader;
+
+// Delta tables are split into blocks of chains. The first
+// key and bit offset of each block is stored in a directory
+typedef struct  __attribute__((__packed__)) _DeltaBlock
+{
+    uint64_t key;
+    uint64_t offset;
+} DeltaBlock;
+
+constexpr size_t kDeltaBlockSize = 64;
+
+// Layouts searched by 64-bit key start their key array on a
+// cache line boundary. For Eytzinger tables this means the
+// descendants of a slot a few levels down fill whole lines
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kAlignedDataOffset = (sizeof(TableHeader) + sizeof(PackedHeader) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+
 typedef uint64_t rowindex_t;
 
+// Batched lookups advance this many searches in turn so
+// that their cache misses overlap
+constexpr size_t kLookupGroupSize = 32;
+
+// The table shape recommended by Plan for a space budget
+typedef struct _TablePlan
+{
+    size_t tables;
+    size_t length;
+    size_t chains;
+    size_t size;
+    double success;
+} TablePlan;
+
+// A split table is described by a text manifest listing its
+// shards. Each shard is an uncompressed table holding every chain
+// whose endpoint starts with a two byte prefix in [first, last]
+constexpr char kManifestMagic[] = "simdrainbowcrack-manifest";
+constexpr size_t kManifestVersion = 1;
+
+typedef struct _TableShard
+{
+    uint16_t first;
+    uint16_t last;
+    size_t chains;
+    std::filesystem::path path;
+} TableShard;
+
+// Merge join cracking computes the endpoint of every target at
+// every column, sorts them in runs of this many candidates and
+// joins them against the sorted table in a single pass
+constexpr size_t kMergeRunCandidates = 1 << 22;
+
+typedef struct __attribute__((__packed__)) _MergeCandidate
+{
+    char     endpoint[MAX_LENGTH];
+    uint32_t target;
+    uint32_t column;
+} MergeCandidate;
+
+typedef struct _MergeMatch
+{
+    uint32_t   target;
+    uint32_t   column;
+    rowindex_t start;
+} MergeMatch;
+
+// Pipelined cracking moves work between stages in batches of this
+// many items, and holds back lookups until this many are queued so
+// that the readahead for each has time to complete
+constexpr size_t kPipelineBatch = 64;
+constexpr size_t kPipelineDepth = 4096;
+
+// Distributed cracking computes this many candidate endpoints at
+// a time and sends each shard its share in a single request
+constexpr size_t kDistributedCandidates = 1 << 20;
+
 class RainbowTable
 {
 public:
@@ -69,6 +199,13 @@ public:
     const size_t GetLength(void) const { return m_Length; }
     void SetBlocksize(const size_t Blocksize) { m_Blocksize = Blocksize % SimdLanes() == 0 ? Blocksize : (Blocksize + SimdLanes()) % SimdLanes(); }
     void SetCount(const size_t Count) { m_Count = Count; }
+    void SetTargetSuccess(const double Target) { m_TargetSuccess = Target; }
+    void SetMinGain(const double Gain) { m_MinGain = Gain; }
+    void SetTableIndex(const size_t Index) { m_TableIndex = Index; }
+    const size_t GetTableIndex(void) const { return m_TableIndex; }
+    void SetFamily(const size_t Members) { m_Family = std::max(Members, (size_t)1); }
+    const size_t GetFamily(void) const { return m_Family; }
+    static const std::filesystem::path FamilyPath(const std::filesystem::path& Path, const size_t TableIndex);
     const size_t GetCount(void) const;
     void SetThreads(const size_t Threads) { m_Threads = Threads; }
     const size_t GetThreads(void) const { return m_Threads; }
@@ -78,40 +215,124 @@ public:
     bool SetType(const std::string Type);
     void SetSeparator(const char Separator) { m_Separator = Separator; }
     const char GetSeparator(void) const { return m_Separator; }
-    std::string GetType(void) const { return m_TableType == TypeCompressed ? "Compressed" : "Uncompressed";  }
+    const TableType GetTableType(void) const { return m_TableType; }
+    std::string GetType(void) const { return TypeToString(m_TableType); }
+    static const std::string TypeToString(const TableType Type);
+    static const TableType ParseType(const std::string& Type);
+    static const std::string ExtensionForType(const TableType Type);
+    static const bool IsPackedType(const TableType Type) { return Type == TypeFingerprint || Type == TypeDelta || Type == TypeEytzinger || Type == TypeColumnar; }
+    void SetFingerprintBits(const size_t Bits) { m_FingerprintBits = Bits; }
+    const size_t GetFingerprintBits(void) const { return m_FingerprintBits; }
+    const size_t GetIndexBits(void) const { return m_IndexBits; }
+    const size_t GetDeltaBits(void) const { return m_DeltaBits; }
+    double GetBitsPerChain(void) const;
+    double GetFalseAlarmRate(void) const;
     float GetCoverage(void);
+    double GetSuccessProbability(void);
     void DisableIndex(void) { m_IndexDisable = true; }
+    void EnableLearnedIndex(void) { m_LearnedSearch = true; }
+    void SetFilterBits(const size_t Bits) { m_FilterBits = Bits; }
+    void EnableMergeJoin(void) { m_MergeJoin = true; }
+    void EnableTableScan(void) { m_TableScan = true; }
+    void EnableScheduler(void) { m_Scheduled = true; }
+    void EnablePipeline(void) { m_Pipelined = true; }
+    bool SetStorage(const std::string& Storage) { m_StorageType = TableStorage::ParseType(Storage); return m_StorageType != StorageInvalid; }
+    bool SetMmapAdvice(const std::string& Advice) { m_MmapAdvice.clear(); return MmapStorage::ParseAdvice(Advice, m_MmapAdvice); }
+    void SetCacheSize(const size_t Bytes) { m_CacheSize = Bytes; }
+    void EnableMlock(void) { m_Mlock = true; }
+    bool SetHugePages(const std::string& Size);
+    void EnablePrefault(void) { m_Prefault = true; }
+    void EnableSharedIndex(void) { m_ShareIndex = true; }
+    size_t Unshare(void) const;
+    bool Warm(void);
+    bool Analyze(void);
+    bool Plan(const size_t SpaceBytes, TablePlan* Recommended = nullptr);
+    std::string GetStorageStats(void) const;
+    void SetBudget(const uint64_t Milliseconds) { m_BudgetMs = Milliseconds; }
+    const double GetLastProbability(void) const { return m_LastProbability; }
+    const bool BudgetExceeded(void) const { return m_BudgetExceeded; }
+    const std::vector<uint8_t>& GetColumnsSearched(void) const { return m_ColumnSearched; }
+    void SetBruteForceLength(const size_t Length) { m_BruteForce = true; m_BruteForceLength = Length; }
+    void SetBruteForceTime(const uint64_t Milliseconds) { m_BruteForce = true; m_BruteForceMs = Milliseconds; }
+    void SetBruteForceLimit(const uint64_t Words) { m_BruteForce = true; m_BruteForceLimit = Words; }
     bool TableExists(void) const { return std::filesystem::exists(m_Path); }
     static bool GetTableHeader(const std::filesystem::path& Path, TableHeader* Header);
     static bool IsTableFile(const std::filesystem::path& Path);
     bool IsTableFile(void) const { return IsTableFile(m_Path); }
-    bool ValidTable(void) const { return TableExists() && IsTableFile(m_Path); }
+    bool ValidTable(void) const { return TableExists() && (IsTableFile(m_Path) || IsManifest(m_Path)); }
+    static bool IsManifest(const std::filesystem::path& Path);
+    bool Sharded(void) const { return !m_Shards.empty(); }
+    const std::vector<TableShard>& GetShards(void) const { return m_ShardRanges; }
+    bool Split(const std::filesystem::path& Destination, const size_t Shards);
+    bool Serve(const std::string& Address);
+    bool Merge(const std::vector<std::filesystem::path>& Tables, const std::filesystem::path& Destination);
     bool LoadTable(void);
     bool Complete(void) const { return m_ThreadsCompleted == m_Threads; }
     std::vector<std::tuple<std::string, std::string>> Crack(std::string& Target);
-    static const size_t ChainWidthForType(const TableType Type, const size_t Max) { return Type == TypeCompressed ? Max : sizeof(rowindex_t) + Max; }
+    static const size_t ChainWidthForType(const TableType Type, const size_t Max) { return IsPackedType(Type) ? 0 : Type == TypeCompressed ? Max : sizeof(rowindex_t) + Max; }
     const size_t GetChainWidth(void) const { return ChainWidthForType(m_TableType, m_Max); }
     static void DoHash(const uint8_t* Data, const size_t Length, uint8_t* Digest, const HashAlgorithm Algorithm) { SimdHashSingle(Algorithm, Length, Data, Digest); };
     static const std::string DoHashHex(const uint8_t* Data, const size_t Length, const HashAlgorithm Algorithm);
     void DoHash(const uint8_t* Data, const size_t Length, uint8_t* Digest) const { DoHash(Data, Length, Digest, m_Algorithm); }
     std::string DoHashHex(const uint8_t* Data, const size_t Length) const { return DoHashHex(Data, Length, m_Algorithm); }
-    void Decompress(const std::filesystem::path& Destination) { ChangeType(Destination, TypeUncompressed); }
+    void Decompress(const std::filesystem::path& Destination, const TableType Type = TypeUncompressed) { ChangeType(Destination, Type); }
     void Compress(const std::filesystem::path& Destination) { ChangeType(Destination, TypeCompressed); }
     void SortTable(void);
     static const Chain GetChain(const std::filesystem::path& Path, const size_t Index);
-    static const Chain ComputeChain(const size_t Index, const size_t Min, const size_t Max, const size_t Length, const HashAlgorithm Algorithm, const std::string& Charset);
+    static const Chain ComputeChain(const size_t Index, const size_t Min, const size_t Max, const size_t Length, const HashAlgorithm Algorithm, const std::string& Charset, const size_t TableIndex = 0);
     inline const uint8_t* GetEndpointAt(const size_t Index) const;
     inline const uint8_t* GetRecordAt(const size_t Index) const;
+    bool PrepareLookup(void);
+    const size_t FindEndpoint(const char* Endpoint, const size_t Length) const;
+    std::vector<size_t> FindCandidates(const char* Endpoint, const size_t Length) const;
+    bool MayContainEndpoint(const char* Endpoint) const;
+    void ReadaheadEndpoint(const char* Endpoint) const;
+    std::vector<size_t> FindEndpoints(const std::vector<std::string>& Endpoints) const;
 protected:
     void SortStartpoints(void);
     void RemoveStartpoints(void);
 private:
     // General purpose
+    void BuildFilter(void);
     void ChangeType(const std::filesystem::path& Destination, const TableType Type);
-    const size_t FindEndpoint(const char* Endpoint, const size_t Length) const;
+    void ConvertViaUncompressed(const std::filesystem::path& Destination, const TableType Type);
+    // Split tables
+    bool LoadManifest(void);
+    bool PrepareShards(void);
+    void SetParametersFromHeader(const TableHeader& Header);
+    bool ValidateMatches(const std::vector<MergeMatch>& Matches, const std::vector<std::vector<uint8_t>>& Targets, std::vector<std::optional<std::string>>& Results) const;
+    void ServeConnection(const int Fd) const;
+    void CrackDistributed(const std::string& Target);
+    const size_t ShardFor(const char* Endpoint) const;
+    // The first two bytes of an endpoint in the order endpoints sort
+    const uint16_t GetEndpointPrefix(const uint8_t* Endpoint) const { return Endpoint[0] << 8 | (m_Max > 1 ? Endpoint[1] : 0); }
+    static const uint64_t HashTableParameters(const TableHeader& Header);
+    // Packed tables
+    bool WriteSortedPairs(const std::filesystem::path& Temporary, const std::function<uint64_t(const uint8_t*)>& KeyFunction, rowindex_t* MaxIndex);
+    FILE* CreatePackedTable(const std::filesystem::path& Destination, const TableType Type, const PackedHeader& Packed);
+    void ConvertToFingerprint(const std::filesystem::path& Destination);
+    void ConvertToDelta(const std::filesystem::path& Destination);
+    const size_t FindDelta(const char* Endpoint, const size_t Length) const;
+    void ConvertToEytzinger(const std::filesystem::path& Destination);
+    const size_t FindEytzinger(const char* Endpoint) const;
+    const uint64_t* GetEytzingerKeys(void) const { return (uint64_t*)(m_MappedTable + kAlignedDataOffset); }
+    const size_t GetEytzingerRecordWidth(void) const { return sizeof(rowindex_t) + (m_EndpointKey.Exact() ? 0 : m_Max); }
+    const uint8_t* GetEytzingerRecord(const size_t Slot) const { return m_MappedTable + kAlignedDataOffset + (m_Chains + 1) * sizeof(uint64_t) + Slot * GetEytzingerRecordWidth(); }
+    void ConvertToColumnar(const std::filesystem::path& Destination);
+    const size_t FindColumnar(const char* Endpoint) const;
+    const uint64_t* GetColumnarKeys(void) const { return (uint64_t*)(m_MappedTable + kAlignedDataOffset); }
+    const rowindex_t* GetColumnarIndices(void) const { return (rowindex_t*)(GetColumnarKeys() + m_Chains); }
+    const uint8_t* GetColumnarEndpoint(const size_t Index) const { return (uint8_t*)(GetColumnarIndices() + m_Chains) + Index * m_Max; }
+    const DeltaBlock* GetDeltaDirectory(void) const { return (DeltaBlock*)(m_MappedTable + m_MappedFileSize) - (GetPackedHeader()->count + GetPackedHeader()->blocksize - 1) / GetPackedHeader()->blocksize; }
+    const uint64_t GetFingerprint(const char* Endpoint, const size_t Length) const;
+    const size_t FindFingerprint(const uint64_t Fingerprint) const;
+    const PackedHeader* GetPackedHeader(void) const { return (PackedHeader*)(m_MappedTable + sizeof(TableHeader)); }
+    const uint8_t* GetPackedData(void) const { return m_MappedTable + sizeof(TableHeader) + sizeof(PackedHeader); }
+    inline const uint64_t GetFingerprintAt(const size_t Index) const;
+    inline const rowindex_t GetFingerprintIndexAt(const size_t Index) const;
     std::optional<std::string> ValidateChain(const size_t ChainIndex, const uint8_t* Hash) const;
-    bool TableMapped(void) { return m_MappedTableFd != nullptr; };
-    bool MapTable(const bool ReadOnly = true);
+    bool TableMapped(void) { return m_Storage != nullptr; };
+    bool MapTable(const bool ReadOnly = true, const StorageType Storage = StorageMmap);
     bool UnmapTable(void);
 #ifdef BIGINT
     static const mpz_class CalculateLowerBound(const size_t Min, const std::string& Charset) { return WordGenerator::WordLengthIndex(Min, Charset); };
@@ -121,17 +342,54 @@ private:
     const uint64_t CalculateLowerBound(void) const { return CalculateLowerBound(m_Min, m_Charset); };
 #endif
     // Building
-    void StoreTableHeader(void) const;
+    const TableHeader MakeTableHeader(const size_t TableIndex) const;
+    void StoreTableHeader(const std::filesystem::path& Path, const size_t TableIndex) const;
     void GenerateBlock(const size_t ThreadId, const size_t BlockId);
     void SaveBlock(const size_t ThreadId, const size_t BlockId, const std::vector<SmallString> Block, const uint64_t Time);
     void OutputStatus(const SmallString& LastEndpoint) const;
     void WriteBlock(const size_t BlockId, const std::vector<SmallString>& Block);
     void BuildThreadCompleted(const size_t ThreadId);
+    // Coverage targeted building
+    void SeedEndpointEstimate(const size_t Member);
+    double BuildSuccess(const double Chains, const std::vector<double>& Ratios) const;
+    void CheckBuildTarget(void);
     // Cracking
     void IndexTable(void);
+    bool ShareIndex(void);
+    void ReleaseIndex(void);
+    void Prefault(void);
+    const std::vector<double>& GetColumnProbabilities(void);
     std::optional<std::string> CrackOne(const std::string& Target);
     void CrackOneWorker(const size_t ThreadId, const std::vector<uint8_t> Target);
     std::optional<std::string> CheckIteration(const HybridReducer& Reducer, const std::vector<uint8_t>& Hash, const size_t Iteration) const;
+    const size_t ComputeEndpoint(const HybridReducer& Reducer, const uint8_t* Target, const size_t Iteration, char* Endpoint) const;
+    bool LoadTargets(const std::string& Target, std::vector<std::string>& Hashes, std::vector<std::vector<uint8_t>>& Targets) const;
+    void RunCrackWorkers(const std::function<void(const size_t ThreadId)>& Worker);
+    // Merge join cracking
+    void CrackMergeJoin(const std::string& Target);
+    void MergeCandidatesWorker(const size_t ThreadId, const std::vector<std::vector<uint8_t>>* Targets, const size_t First, MergeCandidate* Candidates, const size_t Count);
+    void MergeValidateWorker(const size_t ThreadId, const std::vector<MergeMatch>* Matches, const std::vector<std::vector<uint8_t>>* Targets, std::vector<std::optional<std::string>>* Results);
+    // Table scan cracking
+    void CrackTableScan(const std::string& Target);
+    void TableScanWorker(const size_t ThreadId, const TargetSet* Targets, std::vector<std::optional<std::string>>* Results);
+    // Cost ordered cracking
+    void CrackScheduled(const std::string& Target);
+    void ScheduledWorker(const size_t ThreadId, const std::vector<std::string>* Hashes, const std::vector<std::vector<uint8_t>>* Targets, std::vector<std::atomic<bool>>* Solved);
+    // Planning
+    double BenchmarkSteps(const bool Simd) const;
+    // Table families
+    const std::filesystem::path MemberPath(const size_t Member) const { return Member == 0 ? m_Path : FamilyPath(m_Path, m_TableIndex + Member); }
+    bool OpenFamily(void);
+    void CrackFamily(std::string& Target);
+    void MarkSolved(const std::string& Hash);
+    const bool IsSolved(const std::string& Hash) const;
+    void CopyLookupSettings(RainbowTable& Table) const;
+    // Pipelined cracking
+    void CrackPipelined(const std::string& Target);
+    void PipelineWorker(const size_t ThreadId, const std::vector<std::string>* Hashes, const std::vector<std::vector<uint8_t>>* Targets, std::vector<std::atomic<bool>>* Solved);
+    // Brute force cracking
+    bool CrackBruteForce(const std::string& Target);
+    void BruteForceWorker(const size_t ThreadId, const TargetSet* Targets, const std::vector<uint64_t>* Bounds, const uint64_t Last, const std::chrono::steady_clock::time_point Deadline, std::vector<std::optional<std::string>>* Results);
 
     // General purpose
     std::string m_Operation;
@@ -148,26 +406,89 @@ private:
     size_t m_HashWidth = 0;
     size_t m_ChainWidth = 0;
     size_t m_Chains = 0;
+    size_t m_TableIndex = 0;
+    size_t m_Family = 1;
     TableType m_TableType = TypeCompressed;
+    size_t m_FingerprintBits = 32;
+    size_t m_IndexBits = 0;
+    size_t m_DeltaBits = 0;
+    EndpointKey m_EndpointKey;
     dispatch::DispatchPoolPtr m_DispatchPool;
     // For building
     size_t m_StartingChains = 0;
-    FILE* m_WriteHandle = NULL;
+    // One per member of the family being built
+    std::vector<FILE*> m_WriteHandles;
     size_t m_NextWriteBlock = 0;
     std::map<size_t, const std::vector<SmallString>> m_WriteCache;
     size_t m_ThreadsCompleted = 0;
     size_t m_ChainsWritten = 0;
     std::map<size_t, uint64_t> m_ThreadTimers;
+    // Stop once the estimated success reaches the target or
+    // an hour of building would add less than m_MinGain percent
+    double m_TargetSuccess = 0.0;
+    double m_MinGain = 0.0;
+    double m_BuildKeyspace = 0.0;
+    double m_BuildSuccess = 0.0;
+    std::vector<HyperLogLog> m_EndpointEstimates;
+    std::chrono::steady_clock::time_point m_BuildStart;
+    std::atomic<size_t> m_StopBlock = std::numeric_limits<size_t>::max();
     // For cracking
+    // Null when the storage does not map the whole file
     uint8_t* m_MappedTable = nullptr;
-    FILE* m_MappedTableFd = nullptr;
-    size_t m_MappedFileSize;
-    size_t m_MappedTableSize;
+    std::unique_ptr<TableStorage> m_Storage;
+    StorageType m_StorageType = StorageMmap;
+    std::vector<int> m_MmapAdvice;
+    size_t m_CacheSize = 64 * 1024 * 1024;
+    bool m_Mlock = false;
+    size_t m_HugePageSize = 0;
+    bool m_Prefault = false;
+    size_t m_MappedFileSize = 0;
+    size_t m_MappedTableSize = 0;
+    // The first record and number of records for each two byte prefix
     static constexpr size_t LOOKUP_SIZE = std::numeric_limits<uint16_t>::max() + 1;
-    const uint8_t* m_MappedTableLookup[LOOKUP_SIZE];
-    size_t m_MappedTableLookupSize[LOOKUP_SIZE];
+    static constexpr size_t kNoRecord = (size_t)-1;
+    // Point into m_LocalIndex or a segment shared with other processes
+    size_t* m_MappedTableLookup = nullptr;
+    size_t* m_MappedTableLookupSize = nullptr;
+    std::vector<size_t> m_LocalIndex;
+    std::unique_ptr<SharedSegment> m_SharedIndex;
+    bool m_ShareIndex = false;
     bool m_IndexDisable = false;
     bool m_Indexed = false;
+    bool m_LearnedSearch = false;
+    LearnedIndex m_LearnedIndex;
+    size_t m_FilterBits = 0;
+    BlockedBloomFilter m_Filter;
+    bool m_MergeJoin = false;
+    bool m_TableScan = false;
+    std::atomic<size_t> m_TargetsRemaining = 0;
+    std::mutex m_ResultsLock;
+    uint64_t m_BudgetMs = 0;
+    std::chrono::steady_clock::time_point m_Deadline;
+    std::vector<uint8_t> m_ColumnSearched;
+    std::vector<double> m_ColumnProbabilities;
+    double m_LastProbability = 0.0;
+    bool m_BudgetExceeded = false;
+    bool m_Scheduled = false;
+    std::atomic<size_t> m_NextWorkItem = 0;
+    bool m_Pipelined = false;
+    std::mutex m_PipelineLock;
+    std::deque<MergeCandidate> m_LookupQueue;
+    std::deque<MergeMatch> m_VerifyQueue;
+    size_t m_PipelineBusy = 0;
+    bool m_Readahead = false;
+    bool m_BruteForce = false;
+    size_t m_BruteForceLength = 0;
+    uint64_t m_BruteForceMs = 0;
+    uint64_t m_BruteForceLimit = 0;
+    std::atomic<uint64_t> m_BruteForceNext = 0;
+    std::unordered_set<std::string> m_Solved;
+    // Split tables route each lookup to the shard holding its prefix
+    std::vector<TableShard> m_ShardRanges;
+    std::vector<std::unique_ptr<RainbowTable>> m_Shards;
+    // Set on shards served by another process
+    std::unique_ptr<RemoteShard> m_Remote;
+    bool m_Distributed = false;
     bool m_MappedReadOnly = false;
     std::ifstream m_HashFileStream;
     std::mutex m_HashFileStreamLock;
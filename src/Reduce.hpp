@@ -125,12 +125,14 @@ public:
         const size_t Min,
         const size_t Max,
         const size_t HashLength,
-        const std::string& Charset
+        const std::string& Charset,
+        const size_t TableIndex
     ) : m_Min(Min),
         m_Max(Max),
         m_HashLength(HashLength),
         m_HashLengthWords(HashLength/sizeof(uint32_t)),
         m_Charset(Charset),
+        m_TableIndex(TableIndex),
 #ifdef BIGINT
         m_MinIndex(WordGenerator::WordLengthIndex(Min, Charset)),
         m_MaxIndex(WordGenerator::WordLengthIndex(Max + 1, Charset))
@@ -150,10 +152,22 @@ public:
     const size_t GetMax(void) const { return m_Max; }
     const size_t GetHashLength(void) const { return m_HashLength; }
     const std::string& GetCharset(void) const  { return m_Charset; }
+    const size_t GetTableIndex(void) const { return m_TableIndex; }
     const index_t GetMinIndex(void) const { return m_MinIndex; }
     const index_t GetMaxIndex(void) const { return m_MaxIndex; }
     const index_t GetKeyspace(void) const { return m_MaxIndex - m_MinIndex; }
 protected:
+    // Tables in a family differ only by their table index. The
+    // mix is zero for the first table so older tables, which all
+    // have index zero, reduce exactly as they always have
+    inline uint32_t
+    TableMix(
+        const size_t Word
+    ) const
+    {
+        return rotl(0x6ed9eba1 * (uint32_t)m_TableIndex, Word + 16);
+    }
+
     // A basic entropy extension function based on SHA256 extension
     // It replaces the data in a destination buffer
     void ExtendEntropy(
@@ -214,6 +228,7 @@ protected:
     const size_t m_HashLength;
     const size_t m_HashLengthWords;
     const std::string m_Charset;
+    const size_t m_TableIndex;
     const index_t m_MinIndex;
     const index_t m_MaxIndex;
 };
@@ -225,8 +240,9 @@ public:
         const size_t Min,
         const size_t Max,
         const size_t HashLength,
-        const std::string& Charset
-    ) : Reducer(Min, Max, HashLength, Charset) {}
+        const std::string& Charset,
+        const size_t TableIndex = 0
+    ) : Reducer(Min, Max, HashLength, Charset, TableIndex) {}
 
     size_t Reduce(
         char* Destination,
@@ -257,6 +273,7 @@ protected:
     {
         // XOR the current rainbow collumn number
         Value ^= Iteration;
+        Value ^= (size_t)TableMix(0) << 32;
         // Constrain it within the index range
         Value %= GetKeyspace();
         // Add the minimum index to ensure it is >min and <max
@@ -278,8 +295,9 @@ public:
         const size_t Min,
         const size_t Max,
         const size_t HashLength,
-        const std::string& Charset
-    ) : BasicModuloReducer(Min, Max, HashLength, Charset)
+        const std::string& Charset,
+        const size_t TableIndex = 0
+    ) : BasicModuloReducer(Min, Max, HashLength, Charset, TableIndex)
     {
         // Figure out the smallest number of bits of
         // input hash data required to generate a
@@ -344,8 +362,9 @@ public:
         const size_t Min,
         const size_t Max,
         const size_t HashLength,
-        const std::string& Charset
-    ) : Reducer(Min, Max, HashLength, Charset)
+        const std::string& Charset,
+        const size_t TableIndex = 0
+    ) : Reducer(Min, Max, HashLength, Charset, TableIndex)
     {
         index_t total = 0;
         for (size_t i = Min; i <= Max; i++)
@@ -391,7 +410,7 @@ public:
         // Copy and mix in the iteration
         for (size_t i = 0; i < m_HashLengthWords; i++)
         {
-            buffer32[i] = hash32[i] ^ rotl(0x5a827999 * Iteration, i);
+            buffer32[i] = hash32[i] ^ rotl(0x5a827999 * Iteration, i) ^ TableMix(i);
         }
 
         // Initialize the buffer read offset
@@ -466,8 +485,9 @@ public:
         const size_t Min,
         const size_t Max,
         const size_t HashLength,
-        const std::string& Charset
-    ) : Reducer(Min, Max, HashLength, Charset)
+        const std::string& Charset,
+        const size_t TableIndex = 0
+    ) : Reducer(Min, Max, HashLength, Charset, TableIndex)
     {
         assert(Min == Max);
         m_ModMax = calculate_modulo_bias_mask(m_Charset.size());
@@ -483,6 +503,10 @@ public:
         uint8_t buffer[m_HashLength];
         // Copy hash to buffer so we can update it
         memcpy(buffer, Hash, m_HashLength);
+        for (size_t i = 0; i < m_HashLengthWords; i++)
+        {
+            ((uint32_t*)buffer)[i] ^= TableMix(i);
+        }
 
         return GetCharsUnbiased(
             Destination,
@@ -0,0 +1,161 @@
+//
+//  RemoteShard.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "RemoteShard.hpp"
+#include "Socket.hpp"
+
+RemoteShard::~RemoteShard(
+    void
+)
+{
+    if (m_Fd != -1)
+    {
+        close(m_Fd);
+    }
+}
+
+bool
+RemoteShard::Connect(
+    const std::string& Address
+)
+{
+    m_Address = Address;
+    m_Fd = Socket::Connect(Address);
+    return m_Fd != -1;
+}
+
+bool
+RemoteShard::Call(
+    const RemoteOp Op,
+    const uint64_t Count,
+    const std::vector<uint8_t>& Payload,
+    void* Response,
+    const size_t ResponseSize
+)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    if (m_Fd == -1)
+    {
+        return false;
+    }
+
+    const RemoteRequest request = {kRemoteMagic, (uint32_t)Op, Count};
+    if (!Socket::SendAll(m_Fd, &request, sizeof(request)) ||
+        !Socket::SendAll(m_Fd, Payload.data(), Payload.size()) ||
+        !Socket::RecvAll(m_Fd, Response, ResponseSize))
+    {
+        // The stream position is unknown so the connection is dropped
+        std::cerr << "Lost connection to shard " << m_Address << std::endl;
+        close(m_Fd);
+        m_Fd = -1;
+        return false;
+    }
+
+    m_Requests++;
+    m_Items += Count;
+    return true;
+}
+
+bool
+RemoteShard::Hello(
+    void* Header,
+    const size_t HeaderSize,
+    uint64_t* Chains
+)
+{
+    std::vector<uint8_t> response(HeaderSize + sizeof(uint64_t));
+    if (!Call(RemoteHello, 0, {}, &response[0], response.size()))
+    {
+        return false;
+    }
+    memcpy(Header, &response[0], HeaderSize);
+    memcpy(Chains, &response[HeaderSize], sizeof(uint64_t));
+    return true;
+}
+
+bool
+RemoteShard::Find(
+    const std::vector<std::string>& Endpoints,
+    const size_t Width,
+    std::vector<size_t>& Results
+)
+{
+    Results.assign(Endpoints.size(), (size_t)-1);
+    for (size_t first = 0; first < Endpoints.size(); first += kRemoteMaxItems)
+    {
+        const size_t count = std::min(Endpoints.size() - first, (size_t)kRemoteMaxItems);
+        std::vector<uint8_t> payload(count * Width, 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            const std::string& endpoint = Endpoints[first + i];
+            memcpy(&payload[i * Width], endpoint.data(), std::min(endpoint.size(), Width));
+        }
+
+        std::vector<uint64_t> found(count);
+        if (!Call(RemoteFind, count, payload, &found[0], count * sizeof(uint64_t)))
+        {
+            return false;
+        }
+        std::copy(found.begin(), found.end(), Results.begin() + first);
+    }
+    return true;
+}
+
+bool
+RemoteShard::Validate(
+    const std::vector<std::pair<uint64_t, const uint8_t*>>& Chains,
+    const size_t HashWidth,
+    const size_t Width,
+    std::vector<std::optional<std::string>>& Results
+)
+{
+    Results.assign(Chains.size(), std::nullopt);
+    const size_t itemSize = sizeof(uint64_t) + HashWidth;
+    const size_t resultSize = 1 + Width;
+    for (size_t first = 0; first < Chains.size(); first += kRemoteMaxItems)
+    {
+        const size_t count = std::min(Chains.size() - first, (size_t)kRemoteMaxItems);
+        std::vector<uint8_t> payload(count * itemSize);
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(&payload[i * itemSize], &Chains[first + i].first, sizeof(uint64_t));
+            memcpy(&payload[i * itemSize + sizeof(uint64_t)], Chains[first + i].second, HashWidth);
+        }
+
+        std::vector<uint8_t> response(count * resultSize);
+        if (!Call(RemoteValidate, count, payload, &response[0], response.size()))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint8_t* const result = &response[i * resultSize];
+            if (result[0] != kRemoteNotFound && result[0] <= Width)
+            {
+                Results[first + i] = std::string((const char*)result + 1, result[0]);
+            }
+        }
+    }
+    return true;
+}
+
+std::string
+RemoteShard::Stats(
+    void
+) const
+{
+    std::stringstream stats;
+    stats << "remote (" << m_Address << ", " << m_Requests << " requests, " << m_Items << " items)";
+    return stats.str();
+}
@@ -0,0 +1,71 @@
+//
+//  RemoteShard.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef RemoteShard_hpp
+#define RemoteShard_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Requests and responses are sent in the byte order of the hosts,
+// so every host in a cluster must share it. Each request is this
+// header followed by Count items:
+//  - Hello, no items. Answered with the table header and the
+//    number of chains as a uint64_t
+//  - Find, endpoints null padded to the table's maximum length.
+//    Answered with the start index of each as a uint64_t, or -1
+//  - Validate, a uint64_t start index followed by the target hash.
+//    Answered with a length byte and a word padded to the maximum
+//    length. The length is kRemoteNotFound if the chain did not
+//    contain the hash
+constexpr uint32_t kRemoteMagic = 'rtrp';
+constexpr uint64_t kRemoteMaxItems = 1 << 24;
+constexpr uint8_t kRemoteNotFound = 0xff;
+
+typedef enum _RemoteOp
+{
+    RemoteHello,
+    RemoteFind,
+    RemoteValidate
+} RemoteOp;
+
+typedef struct __attribute__((__packed__)) _RemoteRequest
+{
+    uint32_t magic;
+    uint32_t op;
+    uint64_t count;
+} RemoteRequest;
+
+// A connection to a shard served by another process. Requests
+// on one connection are answered in turn so calls are serialised
+class RemoteShard
+{
+public:
+    ~RemoteShard(void);
+    bool Connect(const std::string& Address);
+    bool Hello(void* Header, const size_t HeaderSize, uint64_t* Chains);
+    bool Find(const std::vector<std::string>& Endpoints, const size_t Width, std::vector<size_t>& Results);
+    bool Validate(const std::vector<std::pair<uint64_t, const uint8_t*>>& Chains, const size_t HashWidth, const size_t Width, std::vector<std::optional<std::string>>& Results);
+    std::string Stats(void) const;
+    const std::string& Address(void) const { return m_Address; }
+private:
+    bool Call(const RemoteOp Op, const uint64_t Count, const std::vector<uint8_t>& Payload, void* Response, const size_t ResponseSize);
+
+    int m_Fd = -1;
+    std::string m_Address;
+    std::mutex m_Lock;
+    std::atomic<size_t> m_Requests = 0;
+    std::atomic<size_t> m_Items = 0;
+};
+
+#endif /* RemoteShard_hpp */
@@ -0,0 +1,236 @@
+//
+//  SharedMemory.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "SharedMemory.hpp"
+#include "Util.hpp"
+
+static constexpr char kSegmentMagic[8] = {'S', 'R', 'C', 'S', 'H', 'M', '0', '1'};
+
+SharedSegment::~SharedSegment(
+    void
+)
+{
+    if (m_Header != nullptr)
+    {
+        munmap(m_Header, sizeof(SegmentHeader) + m_Size);
+    }
+    if (m_Fd != -1)
+    {
+        close(m_Fd);
+    }
+}
+
+/* static */
+const std::string
+SharedSegment::NameForFile(
+    const std::filesystem::path& Path,
+    const std::string& Suffix
+)
+{
+    // Identify the file by where it lives and when it last changed
+    struct stat info = {};
+    stat(Path.c_str(), &info);
+    std::stringstream identity;
+    identity << std::filesystem::weakly_canonical(Path).string() << ":";
+    identity << info.st_dev << ":" << info.st_ino << ":" << info.st_size << ":";
+    identity << std::filesystem::last_write_time(Path).time_since_epoch().count();
+    const std::string key = identity.str();
+
+    // Kept short as macOS limits names to 31 characters
+    std::stringstream name;
+    name << "/simdrc-" << std::hex << std::setw(16) << std::setfill('0');
+    name << Util::Hash64((const uint8_t*)key.data(), key.size()) << "." << Suffix;
+    return name.str();
+}
+
+/* static */
+bool
+SharedSegment::Remove(
+    const std::string& Name
+)
+{
+    return shm_unlink(Name.c_str()) == 0;
+}
+
+/* static */
+size_t
+SharedSegment::RemoveAll(
+    void
+)
+{
+    // Names are hashes, so segments left by tables that were since
+    // rebuilt or moved can only be found by listing them. Only Linux
+    // exposes the segments as files
+    size_t removed = 0;
+#ifdef __linux__
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("simdrc-", 0) == 0 && Remove("/" + name))
+        {
+            removed++;
+        }
+    }
+#endif
+    return removed;
+}
+
+bool
+SharedSegment::Open(
+    const std::string& Name,
+    const size_t Size,
+    bool& Created
+)
+{
+    m_Name = Name;
+    Created = false;
+    while (true)
+    {
+        // Exactly one process wins the exclusive create
+        int fd = shm_open(Name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd != -1)
+        {
+            Created = true;
+            return Create(fd, Size);
+        }
+        else if (errno != EEXIST)
+        {
+            std::cerr << "Unable to create shared segment " << Name << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        fd = shm_open(Name.c_str(), O_RDONLY, 0);
+        if (fd != -1)
+        {
+            return Attach(fd, Size);
+        }
+        // Removed between the two opens, try to create it again
+        else if (errno != ENOENT)
+        {
+            std::cerr << "Unable to open shared segment " << Name << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+}
+
+bool
+SharedSegment::Create(
+    const int Fd,
+    const size_t Size
+)
+{
+    m_Fd = Fd;
+    m_Size = Size;
+
+    // Held until the contents are published. Processes
+    // attaching in the meantime block on the lock
+    flock(m_Fd, LOCK_EX);
+
+    const size_t total = sizeof(SegmentHeader) + Size;
+    void* mapping = MAP_FAILED;
+    if (ftruncate(m_Fd, total) == 0)
+    {
+        mapping = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, 0);
+    }
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Unable to allocate shared segment " << m_Name << ": " << strerror(errno) << std::endl;
+        Remove(m_Name);
+        return false;
+    }
+
+    m_Header = (SegmentHeader*)mapping;
+    memcpy(m_Header->magic, kSegmentMagic, sizeof(kSegmentMagic));
+    m_Header->size = Size;
+    m_Header->ready.store(0, std::memory_order_relaxed);
+    m_Data = (uint8_t*)mapping + sizeof(SegmentHeader);
+    return true;
+}
+
+void
+SharedSegment::Publish(
+    void
+)
+{
+    m_Header->ready.store(1, std::memory_order_release);
+    // The creator only reads from here on, like everyone else
+    mprotect(m_Header, sizeof(SegmentHeader) + m_Size, PROT_READ);
+    flock(m_Fd, LOCK_UN);
+}
+
+bool
+SharedSegment::Attach(
+    const int Fd,
+    const size_t Size
+)
+{
+    m_Fd = Fd;
+    const size_t total = sizeof(SegmentHeader) + Size;
+
+    // The creator holds an exclusive lock while it fills the segment.
+    // There is a short window after the create before it takes the
+    // lock, so an unpublished segment is only abandoned once it has
+    // stayed unlocked for a while, e.g. when the creator was killed
+    constexpr size_t kAttempts = 500;
+    for (size_t attempt = 0; attempt < kAttempts; attempt++)
+    {
+        flock(m_Fd, LOCK_SH);
+
+        struct stat info = {};
+        fstat(m_Fd, &info);
+        if ((size_t)info.st_size == total)
+        {
+            void* mapping = mmap(nullptr, total, PROT_READ, MAP_SHARED, m_Fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                flock(m_Fd, LOCK_UN);
+                std::cerr << "Unable to map shared segment " << m_Name << ": " << strerror(errno) << std::endl;
+                return false;
+            }
+
+            SegmentHeader* header = (SegmentHeader*)mapping;
+            if (memcmp(header->magic, kSegmentMagic, sizeof(kSegmentMagic)) == 0 &&
+                header->size == Size &&
+                header->ready.load(std::memory_order_acquire) != 0)
+            {
+                flock(m_Fd, LOCK_UN);
+                m_Header = header;
+                m_Data = (uint8_t*)mapping + sizeof(SegmentHeader);
+                m_Size = Size;
+                return true;
+            }
+            munmap(mapping, total);
+        }
+        else if (info.st_size != 0)
+        {
+            flock(m_Fd, LOCK_UN);
+            std::cerr << "Shared segment " << m_Name << " does not match the table" << std::endl;
+            return false;
+        }
+
+        flock(m_Fd, LOCK_UN);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::cerr << "Shared segment " << m_Name << " was never published, remove it from /dev/shm" << std::endl;
+    return false;
+}
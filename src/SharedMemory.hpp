@@ -0,0 +1,60 @@
+//
+//  SharedMemory.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef SharedMemory_hpp
+#define SharedMemory_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// A named POSIX shared memory segment that is filled once by the
+// first process to open it and attached read only by the rest.
+// Segments outlive the processes that use them and are removed
+// with Remove or RemoveAll
+class SharedSegment
+{
+public:
+    ~SharedSegment(void);
+    // Attaches to the named segment, waiting for it to be published,
+    // or creates it. When Created is set the caller fills Data() and
+    // then calls Publish() so other processes can attach
+    bool Open(const std::string& Name, const size_t Size, bool& Created);
+    void Publish(void);
+    uint8_t* Data(void) const { return m_Data; }
+    const size_t Size(void) const { return m_Size; }
+    const std::string& Name(void) const { return m_Name; }
+
+    // A name unique to the contents of a file, so a rebuilt table
+    // never attaches to a segment made from the previous one
+    static const std::string NameForFile(const std::filesystem::path& Path, const std::string& Suffix);
+    static bool Remove(const std::string& Name);
+    static size_t RemoveAll(void);
+private:
+    typedef struct _SegmentHeader
+    {
+        char magic[8];
+        uint64_t size;
+        std::atomic<uint64_t> ready;
+        uint8_t padding[40];
+    } SegmentHeader;
+    static_assert(sizeof(SegmentHeader) == 64);
+
+    bool Attach(const int Fd, const size_t Size);
+    bool Create(const int Fd, const size_t Size);
+
+    std::string m_Name;
+    int m_Fd = -1;
+    SegmentHeader* m_Header = nullptr;
+    uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+#endif /* SharedMemory_hpp */
@@ -0,0 +1,287 @@
+//
+//  Socket.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Socket.hpp"
+
+namespace Socket
+{
+
+static const std::string kUnixScheme = "unix://";
+static const std::string kTcpScheme = "tcp://";
+
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0;
+#endif
+
+// A peer going away should fail the send rather than
+// raise SIGPIPE, which platforms without MSG_NOSIGNAL
+// only allow to be disabled per socket
+static void
+Configure(
+    const int Fd,
+    const bool Tcp
+)
+{
+    const int on = 1;
+#ifdef SO_NOSIGPIPE
+    setsockopt(Fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    // Requests are small and answered straight away
+    if (Tcp)
+    {
+        setsockopt(Fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+}
+
+static bool
+UnixAddress(
+    const std::string& Address,
+    sockaddr_un& Result
+)
+{
+    const std::string path = Address.substr(kUnixScheme.size());
+    memset(&Result, 0, sizeof(Result));
+    Result.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(Result.sun_path))
+    {
+        std::cerr << "Invalid unix socket path: " << path << std::endl;
+        return false;
+    }
+    memcpy(&Result.sun_path[0], path.c_str(), path.size());
+    return true;
+}
+
+static addrinfo*
+TcpAddress(
+    const std::string& Address,
+    const bool Passive
+)
+{
+    // The port follows the last colon so IPv6 hosts are bracketed
+    const std::string hostport = Address.substr(kTcpScheme.size());
+    const size_t colon = hostport.rfind(':');
+    if (colon == std::string::npos)
+    {
+        std::cerr << "No port in address: " << Address << std::endl;
+        return nullptr;
+    }
+    std::string host = hostport.substr(0, colon);
+    const std::string port = hostport.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+    {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = Passive ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    const int error = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result);
+    if (error != 0)
+    {
+        std::cerr << "Unable to resolve " << Address << ": " << gai_strerror(error) << std::endl;
+        return nullptr;
+    }
+    return result;
+}
+
+bool
+IsAddress(
+    const std::string& Address
+)
+{
+    return Address.starts_with(kUnixScheme) || Address.starts_with(kTcpScheme);
+}
+
+int
+Listen(
+    const std::string& Address
+)
+{
+    int fd = -1;
+    if (Address.starts_with(kUnixScheme))
+    {
+        sockaddr_un address;
+        if (!UnixAddress(Address, address))
+        {
+            return -1;
+        }
+        // A socket left behind by a previous server is replaced
+        unlink(address.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd != -1 && bind(fd, (sockaddr*)&address, sizeof(address)) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    else if (Address.starts_with(kTcpScheme))
+    {
+        addrinfo* addresses = TcpAddress(Address, true);
+        for (addrinfo* next = addresses; next != nullptr && fd == -1; next = next->ai_next)
+        {
+            fd = socket(next->ai_family, next->ai_socktype, next->ai_protocol);
+            if (fd == -1)
+            {
+                continue;
+            }
+            const int on = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (bind(fd, next->ai_addr, next->ai_addrlen) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (addresses != nullptr)
+        {
+            freeaddrinfo(addresses);
+        }
+    }
+    else
+    {
+        std::cerr << "Addresses must start with " << kUnixScheme << " or " << kTcpScheme << std::endl;
+        return -1;
+    }
+
+    if (fd == -1 || listen(fd, SOMAXCONN) != 0)
+    {
+        std::cerr << "Unable to listen on " << Address << ": " << strerror(errno) << std::endl;
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+int
+Accept(
+    const int Listener
+)
+{
+    sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    const int fd = accept(Listener, (sockaddr*)&address, &length);
+    if (fd != -1)
+    {
+        Configure(fd, address.ss_family != AF_UNIX);
+    }
+    return fd;
+}
+
+int
+Connect(
+    const std::string& Address
+)
+{
+    int fd = -1;
+    if (Address.starts_with(kUnixScheme))
+    {
+        sockaddr_un address;
+        if (UnixAddress(Address, address))
+        {
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd != -1 && connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+    else if (Address.starts_with(kTcpScheme))
+    {
+        addrinfo* addresses = TcpAddress(Address, false);
+        for (addrinfo* next = addresses; next != nullptr && fd == -1; next = next->ai_next)
+        {
+            fd = socket(next->ai_family, next->ai_socktype, next->ai_protocol);
+            if (fd != -1 && connect(fd, next->ai_addr, next->ai_addrlen) != 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (addresses != nullptr)
+        {
+            freeaddrinfo(addresses);
+        }
+    }
+
+    if (fd == -1)
+    {
+        std::cerr << "Unable to connect to " << Address << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    Configure(fd, Address.starts_with(kTcpScheme));
+    return fd;
+}
+
+bool
+SendAll(
+    const int Fd,
+    const void* Data,
+    const size_t Length
+)
+{
+    size_t sent = 0;
+    while (sent < Length)
+    {
+        const ssize_t result = send(Fd, (const uint8_t*)Data + sent, Length - sent, kSendFlags);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (result <= 0)
+        {
+            return false;
+        }
+        sent += result;
+    }
+    return true;
+}
+
+bool
+RecvAll(
+    const int Fd,
+    void* Data,
+    const size_t Length
+)
+{
+    size_t received = 0;
+    while (received < Length)
+    {
+        const ssize_t result = recv(Fd, (uint8_t*)Data + received, Length - received, 0);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (result <= 0)
+        {
+            return false;
+        }
+        received += result;
+    }
+    return true;
+}
+
+}
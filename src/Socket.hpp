@@ -0,0 +1,56 @@
+//
+//  Socket.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef Socket_hpp
+#define Socket_hpp
+
+#include <cstddef>
+#include <string>
+
+// Stream sockets addressed as unix:///path/to/socket or
+// tcp://host:port. Functions return -1 or false on failure
+namespace Socket
+{
+
+bool
+IsAddress(
+    const std::string& Address
+);
+
+int
+Listen(
+    const std::string& Address
+);
+
+int
+Accept(
+    const int Listener
+);
+
+int
+Connect(
+    const std::string& Address
+);
+
+bool
+SendAll(
+    const int Fd,
+    const void* Data,
+    const size_t Length
+);
+
+bool
+RecvAll(
+    const int Fd,
+    void* Data,
+    const size_t Length
+);
+
+}
+
+#endif /* Socket_hpp */
@@ -0,0 +1,450 @@
+//
+//  TableStorage.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TableStorage.hpp"
+
+/* static */
+const StorageType
+TableStorage::ParseType(
+    const std::string& Type
+)
+{
+    if (Type == "mmap")
+    {
+        return StorageMmap;
+    }
+    else if (Type == "pread")
+    {
+        return StoragePread;
+    }
+    else if (Type == "memory")
+    {
+        return StorageMemory;
+    }
+    else if (Type == "shared")
+    {
+        return StorageShared;
+    }
+    return StorageInvalid;
+}
+
+/* static */
+const std::string
+TableStorage::TypeToString(
+    const StorageType Type
+)
+{
+    switch (Type)
+    {
+    case StorageMmap:
+        return "mmap";
+    case StoragePread:
+        return "pread";
+    case StorageMemory:
+        return "memory";
+    case StorageShared:
+        return "shared";
+    default:
+        return "invalid";
+    }
+}
+
+/* static */
+void
+TableStorage::AdviseHugePages(
+    const void* Data,
+    const size_t Length
+)
+{
+#ifdef MADV_HUGEPAGE
+    const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    const uintptr_t start = ((uintptr_t)Data + pageSize - 1) & ~(pageSize - 1);
+    const uintptr_t end = ((uintptr_t)Data + Length) & ~(pageSize - 1);
+    if (end > start && madvise((void*)start, end - start, MADV_HUGEPAGE) != 0)
+    {
+        std::cerr << "Unable to request huge pages: " << strerror(errno) << std::endl;
+    }
+#endif
+}
+
+static const std::vector<std::pair<std::string, int>> kAdviceNames = {
+    {"normal", MADV_NORMAL},
+    {"random", MADV_RANDOM},
+    {"sequential", MADV_SEQUENTIAL},
+    {"willneed", MADV_WILLNEED},
+};
+
+MmapStorage::~MmapStorage(
+    void
+)
+{
+    if (m_Data != nullptr)
+    {
+        munmap(m_Data, m_Size);
+    }
+    if (m_Fd != -1)
+    {
+        close(m_Fd);
+    }
+}
+
+/* static */
+bool
+MmapStorage::ParseAdvice(
+    const std::string& Advice,
+    std::vector<int>& Values
+)
+{
+    // A comma separated list, applied in order
+    std::stringstream stream(Advice);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        auto it = std::find_if(kAdviceNames.begin(), kAdviceNames.end(), [&](const auto& Entry) { return Entry.first == name; });
+        if (it == kAdviceNames.end())
+        {
+            return false;
+        }
+        Values.push_back(it->second);
+    }
+    return !Values.empty();
+}
+
+bool
+MmapStorage::Open(
+    const std::filesystem::path& Path,
+    const bool ReadOnly
+)
+{
+    m_Fd = open(Path.c_str(), ReadOnly ? O_RDONLY : O_RDWR);
+    if (m_Fd == -1)
+    {
+        std::cerr << "Unable to open a handle to the table file" << std::endl;
+        return false;
+    }
+
+    m_Size = std::filesystem::file_size(Path);
+    const int prot = ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    const int flags = ReadOnly ? MAP_PRIVATE : MAP_SHARED;
+    m_Data = (uint8_t*)mmap(nullptr, m_Size, prot, flags, m_Fd, 0);
+    if (m_Data == MAP_FAILED)
+    {
+        m_Data = nullptr;
+        std::cerr << "Unable to map table into memory: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Advice values are not flags so each is applied separately
+    for (const int advice : m_Advice)
+    {
+        if (madvise(m_Data, m_Size, advice) != 0)
+        {
+            std::cerr << "Madvise not happy: " << strerror(errno) << std::endl;
+        }
+    }
+
+    // Only takes effect where the kernel supports huge
+    // pages in the page cache for this filesystem
+    if (m_HugePages)
+    {
+        AdviseHugePages(m_Data, m_Size);
+    }
+
+    return true;
+}
+
+void
+MmapStorage::Readahead(
+    const size_t Offset,
+    const size_t Length
+)
+{
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    const size_t start = Offset & ~(pageSize - 1);
+    madvise(m_Data + start, Offset + Length - start, MADV_WILLNEED);
+}
+
+std::string
+MmapStorage::Stats(
+    void
+) const
+{
+    std::string stats = "mmap (";
+    for (size_t i = 0; i < m_Advice.size(); i++)
+    {
+        auto it = std::find_if(kAdviceNames.begin(), kAdviceNames.end(), [&](const auto& Entry) { return Entry.second == m_Advice[i]; });
+        stats += (i > 0 ? "," : "") + it->first;
+    }
+    return stats + (m_HugePages ? ", huge pages)" : ")");
+}
+
+PreadStorage::~PreadStorage(
+    void
+)
+{
+    if (m_Fd != -1)
+    {
+        close(m_Fd);
+    }
+}
+
+bool
+PreadStorage::Open(
+    const std::filesystem::path& Path,
+    const bool ReadOnly
+)
+{
+    if (!ReadOnly)
+    {
+        std::cerr << "Pread storage is read only" << std::endl;
+        return false;
+    }
+
+    m_Fd = open(Path.c_str(), O_RDONLY);
+    if (m_Fd == -1)
+    {
+        std::cerr << "Unable to open a handle to the table file" << std::endl;
+        return false;
+    }
+
+    m_Size = std::filesystem::file_size(Path);
+    m_Pages = std::make_unique<CachedPage[]>(m_CachePages);
+    m_Cache.resize(m_CachePages * kPageSize);
+    return true;
+}
+
+const uint8_t*
+PreadStorage::Read(
+    const size_t Offset,
+    const size_t Length,
+    uint8_t* Scratch
+)
+{
+    // Copy out of each cached page the range touches. Pages are
+    // locked while they are filled or copied from
+    size_t copied = 0;
+    while (copied < Length)
+    {
+        const size_t offset = Offset + copied;
+        const size_t page = offset / kPageSize;
+        const size_t slot = page % m_CachePages;
+        uint8_t* const data = &m_Cache[slot * kPageSize];
+        CachedPage& cached = m_Pages[slot];
+
+        std::lock_guard<std::mutex> lock(cached.lock);
+        if (cached.page != page)
+        {
+            const ssize_t result = pread(m_Fd, data, kPageSize, page * kPageSize);
+            if (result < 0)
+            {
+                std::cerr << "Unable to read table: " << strerror(errno) << std::endl;
+                memset(data, 0, kPageSize);
+            }
+            cached.page = page;
+            m_Misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            m_Hits.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const size_t count = std::min(Length - copied, kPageSize - offset % kPageSize);
+        memcpy(Scratch + copied, data + offset % kPageSize, count);
+        copied += count;
+    }
+    return Scratch;
+}
+
+void
+PreadStorage::Readahead(
+    const size_t Offset,
+    const size_t Length
+)
+{
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(m_Fd, Offset, Length, POSIX_FADV_WILLNEED);
+#endif
+}
+
+std::string
+PreadStorage::Stats(
+    void
+) const
+{
+    std::stringstream stats;
+    stats << "pread (" << m_CachePages * kPageSize / (1024 * 1024) << "MB cache, ";
+    stats << m_Hits << " hits, " << m_Misses << " misses)";
+    return stats.str();
+}
+
+MemoryStorage::~MemoryStorage(
+    void
+)
+{
+    if (m_Data != nullptr)
+    {
+        if (m_Locked)
+        {
+            munlock(m_Data, m_Allocated);
+        }
+        munmap(m_Data, m_Allocated);
+    }
+}
+
+bool
+MemoryStorage::Open(
+    const std::filesystem::path& Path,
+    const bool ReadOnly
+)
+{
+    if (!ReadOnly)
+    {
+        std::cerr << "Memory storage is read only" << std::endl;
+        return false;
+    }
+
+    const int fd = open(Path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        std::cerr << "Unable to open a handle to the table file" << std::endl;
+        return false;
+    }
+    m_Size = std::filesystem::file_size(Path);
+
+    // Explicit huge pages need to be reserved by the administrator
+    // so fall back to asking for transparent huge pages. The page
+    // size is encoded as its log2 in the mmap flags
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    m_Allocated = (m_Size + m_HugePageSize - 1) / m_HugePageSize * m_HugePageSize;
+    const int hugeFlags = MAP_HUGETLB | (__builtin_ctzll(m_HugePageSize) << MAP_HUGE_SHIFT);
+    m_Data = (uint8_t*)mmap(nullptr, m_Allocated, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | hugeFlags, -1, 0);
+    m_HugeTlb = m_Data != MAP_FAILED;
+#endif
+    if (!m_HugeTlb)
+    {
+        constexpr size_t kTransparentHugePageSize = 2 * 1024 * 1024;
+        m_Allocated = (m_Size + kTransparentHugePageSize - 1) / kTransparentHugePageSize * kTransparentHugePageSize;
+        m_Data = (uint8_t*)mmap(nullptr, m_Allocated, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m_Data == MAP_FAILED)
+        {
+            m_Data = nullptr;
+            close(fd);
+            std::cerr << "Unable to allocate memory for the table: " << strerror(errno) << std::endl;
+            return false;
+        }
+        AdviseHugePages(m_Data, m_Allocated);
+    }
+
+    size_t loaded = 0;
+    while (loaded < m_Size)
+    {
+        const ssize_t result = pread(fd, m_Data + loaded, m_Size - loaded, loaded);
+        if (result <= 0)
+        {
+            close(fd);
+            std::cerr << "Unable to read table into memory: " << strerror(errno) << std::endl;
+            return false;
+        }
+        loaded += result;
+    }
+    close(fd);
+
+    // Locking is best effort as it is limited by RLIMIT_MEMLOCK
+    if (m_Lock)
+    {
+        m_Locked = mlock(m_Data, m_Allocated) == 0;
+        if (!m_Locked)
+        {
+            std::cerr << "Unable to lock table in memory: " << strerror(errno) << std::endl;
+        }
+    }
+
+    return true;
+}
+
+std::string
+MemoryStorage::Stats(
+    void
+) const
+{
+    std::stringstream stats;
+    stats << "memory (" << (m_Size + 1024 * 1024 - 1) / (1024 * 1024) << "MB, ";
+    stats << (m_HugeTlb ? std::to_string(m_HugePageSize / (1024 * 1024)) + "MB huge pages" : "transparent huge pages");
+    stats << (m_Locked ? ", locked)" : ")");
+    return stats.str();
+}
+
+bool
+SharedStorage::Open(
+    const std::filesystem::path& Path,
+    const bool ReadOnly
+)
+{
+    if (!ReadOnly)
+    {
+        std::cerr << "Shared storage is read only" << std::endl;
+        return false;
+    }
+
+    m_Size = std::filesystem::file_size(Path);
+    if (!m_Segment.Open(SharedSegment::NameForFile(Path, "tbl"), m_Size, m_Created))
+    {
+        return false;
+    }
+
+    // Only the first process reads the file
+    if (m_Created)
+    {
+        const int fd = open(Path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            std::cerr << "Unable to open a handle to the table file" << std::endl;
+            SharedSegment::Remove(m_Segment.Name());
+            return false;
+        }
+
+        size_t loaded = 0;
+        while (loaded < m_Size)
+        {
+            const ssize_t result = pread(fd, m_Segment.Data() + loaded, m_Size - loaded, loaded);
+            if (result <= 0)
+            {
+                close(fd);
+                std::cerr << "Unable to read table into memory: " << strerror(errno) << std::endl;
+                SharedSegment::Remove(m_Segment.Name());
+                return false;
+            }
+            loaded += result;
+        }
+        close(fd);
+        m_Segment.Publish();
+    }
+
+    m_Data = m_Segment.Data();
+    return true;
+}
+
+std::string
+SharedStorage::Stats(
+    void
+) const
+{
+    std::stringstream stats;
+    stats << "shared (" << m_Segment.Name() << ", " << (m_Size + 1024 * 1024 - 1) / (1024 * 1024) << "MB, ";
+    stats << (m_Created ? "loaded)" : "attached)");
+    return stats.str();
+}
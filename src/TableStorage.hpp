@@ -0,0 +1,143 @@
+//
+//  TableStorage.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef TableStorage_hpp
+#define TableStorage_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SharedMemory.hpp"
+
+typedef enum _StorageType
+{
+    StorageMmap,
+    StoragePread,
+    StorageMemory,
+    StorageShared,
+    StorageInvalid
+} StorageType;
+
+// Where the bytes of a table file come from. Backends that hold
+// the whole file in the address space expose it through Data().
+// Others copy the requested bytes into a caller supplied buffer
+class TableStorage
+{
+public:
+    virtual ~TableStorage(void) {};
+    virtual bool Open(const std::filesystem::path& Path, const bool ReadOnly) = 0;
+    // Returns Length bytes from Offset, either in place or in Scratch
+    virtual const uint8_t* Read(const size_t Offset, const size_t Length, uint8_t* Scratch) = 0;
+    // Hints that a range will be read soon
+    virtual void Readahead(const size_t Offset, const size_t Length) {};
+    virtual std::string Stats(void) const = 0;
+    uint8_t* Data(void) const { return m_Data; }
+    const size_t Size(void) const { return m_Size; }
+    const StorageType Type(void) const { return m_Type; }
+
+    // Asks for transparent huge pages over the whole pages in a range
+    static void AdviseHugePages(const void* Data, const size_t Length);
+    static const StorageType ParseType(const std::string& Type);
+    static const std::string TypeToString(const StorageType Type);
+protected:
+    StorageType m_Type = StorageInvalid;
+    uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+// The file is mapped and paged in by the kernel. The advice suits
+// the device, e.g. random for NVMe or sequential for network mounts
+class MmapStorage final : public TableStorage
+{
+public:
+    MmapStorage(void) { m_Type = StorageMmap; }
+    ~MmapStorage(void);
+    bool Open(const std::filesystem::path& Path, const bool ReadOnly) override;
+    const uint8_t* Read(const size_t Offset, const size_t Length, uint8_t* Scratch) override { return m_Data + Offset; }
+    void Readahead(const size_t Offset, const size_t Length) override;
+    std::string Stats(void) const override;
+    void SetAdvice(const std::vector<int>& Advice) { m_Advice = Advice; }
+    void SetHugePages(const bool HugePages) { m_HugePages = HugePages; }
+    static bool ParseAdvice(const std::string& Advice, std::vector<int>& Values);
+private:
+    int m_Fd = -1;
+    std::vector<int> m_Advice;
+    bool m_HugePages = false;
+};
+
+// Reads go through pread and a small direct mapped cache of file
+// pages. Suits filesystems where page faults are expensive or the
+// table should not compete with other users of the page cache
+class PreadStorage final : public TableStorage
+{
+public:
+    static constexpr size_t kPageSize = 4096;
+    PreadStorage(void) { m_Type = StoragePread; }
+    ~PreadStorage(void);
+    bool Open(const std::filesystem::path& Path, const bool ReadOnly) override;
+    const uint8_t* Read(const size_t Offset, const size_t Length, uint8_t* Scratch) override;
+    void Readahead(const size_t Offset, const size_t Length) override;
+    std::string Stats(void) const override;
+    void SetCacheSize(const size_t Bytes) { m_CachePages = std::max(Bytes / kPageSize, (size_t)1); }
+private:
+    typedef struct _CachedPage
+    {
+        std::mutex lock;
+        size_t page = (size_t)-1;
+    } CachedPage;
+
+    int m_Fd = -1;
+    size_t m_CachePages = 16384;
+    std::unique_ptr<CachedPage[]> m_Pages;
+    std::vector<uint8_t> m_Cache;
+    std::atomic<size_t> m_Hits = 0;
+    std::atomic<size_t> m_Misses = 0;
+};
+
+// The whole file is read into anonymous memory, on huge pages when
+// the system has them, and optionally locked so it is never swapped
+class MemoryStorage final : public TableStorage
+{
+public:
+    MemoryStorage(void) { m_Type = StorageMemory; }
+    ~MemoryStorage(void);
+    bool Open(const std::filesystem::path& Path, const bool ReadOnly) override;
+    const uint8_t* Read(const size_t Offset, const size_t Length, uint8_t* Scratch) override { return m_Data + Offset; }
+    std::string Stats(void) const override;
+    void SetLocked(const bool Locked) { m_Lock = Locked; }
+    void SetHugePageSize(const size_t Bytes) { m_HugePageSize = Bytes; }
+private:
+    size_t m_HugePageSize = 2 * 1024 * 1024;
+    size_t m_Allocated = 0;
+    bool m_Lock = false;
+    bool m_HugeTlb = false;
+    bool m_Locked = false;
+};
+
+// The whole file is loaded once into a named shared memory segment
+// that every crack process on the host maps read only
+class SharedStorage final : public TableStorage
+{
+public:
+    SharedStorage(void) { m_Type = StorageShared; }
+    bool Open(const std::filesystem::path& Path, const bool ReadOnly) override;
+    const uint8_t* Read(const size_t Offset, const size_t Length, uint8_t* Scratch) override { return m_Data + Offset; }
+    std::string Stats(void) const override;
+private:
+    SharedSegment m_Segment;
+    bool m_Created = false;
+};
+
+#endif /* TableStorage_hpp */
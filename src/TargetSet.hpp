@@ -0,0 +1,120 @@
+//
+//  TargetSet.hpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#ifndef TargetSet_hpp
+#define TargetSet_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// An open addressing set of target digests. Digests are already
+// uniformly distributed so their first eight bytes are used as a
+// tag directly. Tags are stored eight to a cache line and a probe
+// compares a whole line at once before checking the full digest
+class TargetSet
+{
+public:
+    void Init(
+        const std::vector<std::vector<uint8_t>>& Digests,
+        const size_t Width
+    )
+    {
+        m_Width = Width;
+        m_Digests.clear();
+        for (const auto& digest : Digests)
+        {
+            m_Digests.insert(m_Digests.end(), digest.begin(), digest.begin() + Width);
+        }
+
+        // Keep the set at most half full
+        const size_t buckets = std::max((Digests.size() * 2 + kSlots - 1) / kSlots, (size_t)1);
+        m_Buckets.assign(buckets, Bucket{});
+        m_Indices.assign(buckets * kSlots, 0);
+        for (size_t i = 0; i < Digests.size(); i++)
+        {
+            const uint64_t tag = Tag(&Digests[i][0]);
+            for (size_t bucket = Home(tag);; bucket = (bucket + 1) % m_Buckets.size())
+            {
+                size_t slot = 0;
+                while (slot < kSlots && m_Buckets[bucket].tags[slot] != 0)
+                {
+                    slot++;
+                }
+                if (slot < kSlots)
+                {
+                    m_Buckets[bucket].tags[slot] = tag;
+                    m_Indices[bucket * kSlots + slot] = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Returns the index of the matching digest or -1
+    const size_t Find(
+        const uint8_t* const Digest
+    ) const
+    {
+        const uint64_t tag = Tag(Digest);
+        for (size_t bucket = Home(tag);; bucket = (bucket + 1) % m_Buckets.size())
+        {
+            const Bucket& entry = m_Buckets[bucket];
+            uint32_t matches = 0;
+            uint32_t empty = 0;
+            for (size_t slot = 0; slot < kSlots; slot++)
+            {
+                matches |= (entry.tags[slot] == tag) << slot;
+                empty |= (entry.tags[slot] == 0) << slot;
+            }
+            while (matches != 0)
+            {
+                const size_t slot = __builtin_ctz(matches);
+                const size_t index = m_Indices[bucket * kSlots + slot];
+                if (memcmp(&m_Digests[index * m_Width], Digest, m_Width) == 0)
+                {
+                    return index;
+                }
+                matches &= matches - 1;
+            }
+            // Insertion fills a bucket before moving on
+            if (empty != 0)
+            {
+                return (size_t)-1;
+            }
+        }
+    }
+
+    const size_t Size(void) const { return m_Width == 0 ? 0 : m_Digests.size() / m_Width; }
+private:
+    static constexpr size_t kSlots = 8;
+    typedef struct alignas(64) _Bucket
+    {
+        uint64_t tags[kSlots];
+    } Bucket;
+
+    // Zero marks an empty slot so it is never used as a tag
+    static inline uint64_t Tag(
+        const uint8_t* const Digest
+    )
+    {
+        uint64_t tag;
+        memcpy(&tag, Digest, sizeof(tag));
+        return tag | 1;
+    }
+    inline size_t Home(const uint64_t Tag) const { return (size_t)(((unsigned __int128)Tag * m_Buckets.size()) >> 64); }
+
+    std::vector<Bucket> m_Buckets;
+    std::vector<uint32_t> m_Indices;
+    std::vector<uint8_t> m_Digests;
+    size_t m_Width = 0;
+};
+
+#endif /* TargetSet_hpp */
@@ -6,9 +6,11 @@
 //  Copyright © 2024 Kryc. All rights reserved.
 //
 
-#include <vector>
-#include <string>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
 #include "Util.hpp"
 
 namespace Util
@@ -237,4 +239,70 @@ SizeFactor(
     return value;
 }
 
+const double
+TimeFactor(
+    const double Seconds,
+    std::string& HumanFactor
+)
+{
+    double value = Seconds;
+    if (value > 86400 * 365)
+    {
+        value /= 86400 * 365;
+        HumanFactor = "y";
+        return value;
+    }
+    else if (value > 86400)
+    {
+        value /= 86400;
+        HumanFactor = "d";
+        return value;
+    }
+    else if (value > 3600)
+    {
+        value /= 3600;
+        HumanFactor = "h";
+        return value;
+    }
+    else if (value > 60)
+    {
+        value /= 60;
+        HumanFactor = "m";
+        return value;
+    }
+    else if (value < 1)
+    {
+        value *= 1000;
+        HumanFactor = "ms";
+        return value;
+    }
+    HumanFactor = "s";
+    return value;
+}
+
+uint64_t
+Hash64(
+    const uint8_t* Data,
+    const size_t Length
+)
+{
+    // A fast non-cryptographic hash built from the
+    // splitmix64 mixing function
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ Length;
+    for (size_t i = 0; i < Length; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, Data + i, std::min(sizeof(uint64_t), Length - i));
+        hash ^= word;
+        hash *= 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 31;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
 }
\ No newline at end of file
@@ -61,6 +61,18 @@ SizeFactor(
     std::string& HumanFactor
 );
 
+const double
+TimeFactor(
+    const double Seconds,
+    std::string& HumanFactor
+);
+
+uint64_t
+Hash64(
+    const uint8_t* Data,
+    const size_t Length
+);
+
 }
 
 #endif /* Util_hpp */
\ No newline at end of file
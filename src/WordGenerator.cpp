@@ -157,6 +157,28 @@ WordGenerator::GenerateWordReversed(
     return length;
 }
 
+// Static
+// Unlike GenerateWord every one of the Charset^Length words
+// of the given length is produced, including those ending in
+// the first character of the charset
+void
+WordGenerator::GenerateWordFixed(
+    char* Destination,
+    const size_t Length,
+    const uint64_t Value,
+    const std::string& Charset
+)
+{
+    uint64_t i = Value;
+    const size_t charsetSize = Charset.size();
+
+    for (size_t length = 0; length < Length; length++)
+    {
+        Destination[length] = Charset[i % charsetSize];
+        i /= charsetSize;
+    }
+}
+
 const std::string
 WordGenerator::Generate(
     const uint64_t Value
@@ -47,6 +47,7 @@ public:
     static const size_t GenerateWordReversed(char * Destination, const size_t DestSize, const mpz_class& Value, const std::string& Charset);
     static const size_t GenerateWord(char * Destination, const size_t DestSize, const uint64_t Value, const std::string& Charset);
     static const size_t GenerateWordReversed(char * Destination, const size_t DestSize, const uint64_t Value, const std::string& Charset);
+    static void GenerateWordFixed(char * Destination, const size_t Length, const uint64_t Value, const std::string& Charset);
     const std::string   Generate(const uint64_t Value);
     const std::string   GenerateReversed(const uint64_t Value);
     const std::string   Generate(const mpz_class& Value);
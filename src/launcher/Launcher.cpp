@@ -0,0 +1,127 @@
+//
+//  Launcher.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+// SimdHash fixes the number of lanes when it is compiled, so each
+// instruction set is built as its own executable. This picks the
+// widest one the CPU supports and replaces itself with it
+
+// Ordered from the widest vectors down
+static const std::vector<std::string> kVariants = {"avx512", "avx2", "sse41"};
+
+static bool
+Supported(
+    const std::string& Variant
+)
+{
+    __builtin_cpu_init();
+    if (Variant == "avx512")
+    {
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    else if (Variant == "avx2")
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    else if (Variant == "sse41")
+    {
+        return __builtin_cpu_supports("sse4.1");
+    }
+    return false;
+}
+
+// The variants are installed alongside the launcher
+static std::filesystem::path
+ExecutableDirectory(
+    const char* Argv0
+)
+{
+    std::error_code error;
+#ifdef __APPLE__
+    char path[PATH_MAX];
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) == 0)
+    {
+        return std::filesystem::canonical(path, error).parent_path();
+    }
+#else
+    const std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (!error)
+    {
+        return path.parent_path();
+    }
+#endif
+    return std::filesystem::absolute(Argv0).parent_path();
+}
+
+int
+main(
+    int argc,
+    char* argv[]
+)
+{
+    // --isa overrides the choice, e.g. to compare the variants
+    std::string variant;
+    std::vector<char*> arguments = {argv[0]};
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--isa") == 0 && i + 1 < argc)
+        {
+            variant = argv[++i];
+        }
+        else
+        {
+            arguments.push_back(argv[i]);
+        }
+    }
+    arguments.push_back(nullptr);
+
+    if (variant.empty())
+    {
+        for (const std::string& candidate : kVariants)
+        {
+            if (Supported(candidate))
+            {
+                variant = candidate;
+                break;
+            }
+        }
+        if (variant.empty())
+        {
+            std::cerr << "This CPU supports none of the built instruction sets" << std::endl;
+            return 1;
+        }
+    }
+    else if (std::find(kVariants.begin(), kVariants.end(), variant) == kVariants.end())
+    {
+        std::cerr << "Unknown instruction set " << variant << ", expected avx512, avx2 or sse41" << std::endl;
+        return 1;
+    }
+    else if (!Supported(variant))
+    {
+        std::cerr << "This CPU does not support " << variant << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path path = ExecutableDirectory(argv[0]) / ("simdrainbowcrack-" + variant);
+    execv(path.c_str(), arguments.data());
+    std::cerr << "Unable to run " << path << ": " << strerror(errno) << std::endl;
+    return 1;
+}
@@ -7,12 +7,15 @@
 //
 
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <string>
 
 #include "simdhash.h"
 
 #include "RainbowTable.hpp"
+#include "SharedMemory.hpp"
 
 #define ARGCHECK() \
     if (argc <= i) \
@@ -48,7 +51,12 @@ main(
 )
 {
     RainbowTable rainbow;
-    std::string action, target, destination;
+    std::string action, target, destination, listen;
+    TableType destinationType = TypeUncompressed;
+    size_t shards = 2;
+    size_t space = 0;
+    bool allSegments = false;
+    std::vector<std::filesystem::path> tables;
 
     if (argc < 2)
     {
@@ -57,7 +65,12 @@ main(
     }
 
     size_t avx = SimdLanes() * 32;
+#ifdef SIMD_VARIANT
+    // Chosen by the launcher, or with --isa
+    std::cout << "SimdRainbowCrack (AVX-" << avx << ", " << SIMD_VARIANT << ")" << std::endl;
+#else
     std::cout << "SimdRainbowCrack (AVX-" << avx << ")" << std::endl;
+#endif
 
     action = argv[1];
 
@@ -91,7 +104,13 @@ main(
         else if (arg == "--length")
         {
             ARGCHECK();
-            rainbow.SetLength(std::atoi(argv[++i]));
+            const size_t length = std::stoull(argv[++i]);
+            if (length > std::numeric_limits<uint32_t>::max())
+            {
+                std::cerr << "Chain length must be below 2^32" << std::endl;
+                return 1;
+            }
+            rainbow.SetLength(length);
         }
         else if (arg == "--blocksize")
         {
@@ -103,6 +122,32 @@ main(
             ARGCHECK();
             rainbow.SetCount(std::atoi(argv[++i]));
         }
+        else if (arg == "--target-success")
+        {
+            ARGCHECK();
+            rainbow.SetTargetSuccess(std::atof(argv[++i]));
+        }
+        else if (arg == "--min-gain")
+        {
+            ARGCHECK();
+            rainbow.SetMinGain(std::atof(argv[++i]));
+        }
+        else if (arg == "--table-index")
+        {
+            ARGCHECK();
+            rainbow.SetTableIndex(std::atoi(argv[++i]));
+        }
+        else if (arg == "--family")
+        {
+            ARGCHECK();
+            rainbow.SetFamily(std::atoi(argv[++i]));
+        }
+        else if (arg == "--isa")
+        {
+            // Handled by the launcher before this binary is chosen
+            ARGCHECK();
+            i++;
+        }
         else if (arg == "--threads")
         {
             ARGCHECK();
@@ -137,15 +182,143 @@ main(
         {
             rainbow.DisableIndex();
         }
+        else if (arg == "--learned")
+        {
+            rainbow.EnableLearnedIndex();
+        }
+        else if (arg == "--merge")
+        {
+            rainbow.EnableMergeJoin();
+        }
+        else if (arg == "--scan")
+        {
+            rainbow.EnableTableScan();
+        }
+        else if (arg == "--budget-ms")
+        {
+            ARGCHECK();
+            rainbow.SetBudget(std::stoull(argv[++i]));
+        }
+        else if (arg == "--storage")
+        {
+            ARGCHECK();
+            if (!rainbow.SetStorage(argv[++i]))
+            {
+                std::cerr << "Invalid storage: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--mmap-advice")
+        {
+            ARGCHECK();
+            if (!rainbow.SetMmapAdvice(argv[++i]))
+            {
+                std::cerr << "Invalid mmap advice: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--cache-mb")
+        {
+            ARGCHECK();
+            rainbow.SetCacheSize(std::stoull(argv[++i]) * 1024 * 1024);
+        }
+        else if (arg == "--mlock")
+        {
+            rainbow.EnableMlock();
+        }
+        else if (arg == "--hugepages")
+        {
+            ARGCHECK();
+            if (!rainbow.SetHugePages(argv[++i]))
+            {
+                std::cerr << "Invalid huge page size: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--prefault")
+        {
+            rainbow.EnablePrefault();
+        }
+        else if (arg == "--shared-index")
+        {
+            rainbow.EnableSharedIndex();
+        }
+        else if (arg == "--all")
+        {
+            allSegments = true;
+        }
+        else if (arg == "--pipeline")
+        {
+            rainbow.EnablePipeline();
+        }
+        else if (arg == "--schedule")
+        {
+            rainbow.EnableScheduler();
+        }
+        else if (arg == "--brute")
+        {
+            ARGCHECK();
+            rainbow.SetBruteForceLength(std::atoi(argv[++i]));
+        }
+        else if (arg == "--brute-ms")
+        {
+            ARGCHECK();
+            rainbow.SetBruteForceTime(std::stoull(argv[++i]));
+        }
+        else if (arg == "--brute-limit")
+        {
+            ARGCHECK();
+            rainbow.SetBruteForceLimit(std::stoull(argv[++i]));
+        }
+        else if (arg == "--filter-bits")
+        {
+            ARGCHECK();
+            rainbow.SetFilterBits(std::atoi(argv[++i]));
+        }
+        else if (arg == "--type")
+        {
+            ARGCHECK();
+            destinationType = RainbowTable::ParseType(argv[++i]);
+            if (destinationType == TypeInvalid)
+            {
+                std::cerr << "Invalid table type: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--listen")
+        {
+            ARGCHECK();
+            listen = argv[++i];
+        }
+        else if (arg == "--space-mb")
+        {
+            ARGCHECK();
+            space = std::stoull(argv[++i]) * 1024 * 1024;
+        }
+        else if (arg == "--shards")
+        {
+            ARGCHECK();
+            shards = std::atoi(argv[++i]);
+        }
+        else if (arg == "--fingerprint-bits")
+        {
+            ARGCHECK();
+            rainbow.SetFingerprintBits(std::atoi(argv[++i]));
+        }
         else if (rainbow.GetPath().empty())
         {
             rainbow.SetPath(argv[i]);
+            tables.push_back(argv[i]);
+        }
+        else if (action == "merge")
+        {
+            tables.push_back(argv[i]);
         }
         else if (action == "crack" || action == "test")
         {
             target = argv[i];
         }
-        else if (action == "decompress" || action == "compress")
+        else if (action == "decompress" || action == "compress" || action == "split")
         {
             destination = argv[i];
         }
@@ -171,6 +344,58 @@ main(
 
         rainbow.Crack(target);
     }
+    else if (action == "warm")
+    {
+        int check = VerifyAndLoad(rainbow);
+        if (check != 0)
+        {
+            return check;
+        }
+
+        if (!rainbow.Warm())
+        {
+            return 1;
+        }
+    }
+    else if (action == "unshare")
+    {
+        // Segments stay in memory after every process has exited
+        size_t removed = 0;
+        if (!rainbow.GetPath().empty())
+        {
+            int check = VerifyAndLoad(rainbow);
+            if (check != 0)
+            {
+                return check;
+            }
+            removed += rainbow.Unshare();
+        }
+        if (allSegments)
+        {
+            removed += SharedSegment::RemoveAll();
+        }
+        std::cerr << "Removed " << removed << " shared segments" << std::endl;
+    }
+    else if (action == "plan")
+    {
+        if (!rainbow.Plan(space))
+        {
+            return 1;
+        }
+    }
+    else if (action == "analyze")
+    {
+        int check = VerifyAndLoad(rainbow);
+        if (check != 0)
+        {
+            return check;
+        }
+
+        if (!rainbow.Analyze())
+        {
+            return 1;
+        }
+    }
     else if (action == "decompress" || action == "compress")
     {
         if (!rainbow.ValidTable())
@@ -191,15 +416,73 @@ main(
             {
                 auto tablepath = rainbow.GetPath();
                 auto extension = tablepath.extension();
-                destination = tablepath.replace_extension(".utbl");
+                destination = tablepath.replace_extension(RainbowTable::ExtensionForType(destinationType));
             }
-            rainbow.Decompress(destination);
+            rainbow.Decompress(destination, destinationType);
         }
         else
         {
             rainbow.Compress(destination);
         }
     }
+    else if (action == "serve")
+    {
+        int check = VerifyAndLoad(rainbow);
+        if (check != 0)
+        {
+            return check;
+        }
+
+        if (listen.empty())
+        {
+            std::cerr << "No address specified with --listen" << std::endl;
+            return 1;
+        }
+
+        // Only returns on error
+        rainbow.Serve(listen);
+        return 1;
+    }
+    else if (action == "merge")
+    {
+        // The last table named is the destination
+        if (tables.size() < 3)
+        {
+            std::cerr << "Merge needs at least two tables and a destination" << std::endl;
+            return 1;
+        }
+        destination = tables.back();
+        tables.pop_back();
+
+        int check = VerifyAndLoad(rainbow);
+        if (check != 0)
+        {
+            return check;
+        }
+
+        if (!rainbow.Merge(tables, destination))
+        {
+            return 1;
+        }
+    }
+    else if (action == "split")
+    {
+        int check = VerifyAndLoad(rainbow);
+        if (check != 0)
+        {
+            return check;
+        }
+
+        // Shards are written next to the table by default
+        if (destination.empty())
+        {
+            destination = rainbow.GetPath().parent_path();
+        }
+        if (!rainbow.Split(destination, shards))
+        {
+            return 1;
+        }
+    }
     else if (action == "info")
     {
         if (!rainbow.TableExists())
@@ -208,7 +491,7 @@ main(
             return 1;
         }
 
-        if (!rainbow.IsTableFile())
+        if (!rainbow.IsTableFile() && !RainbowTable::IsManifest(rainbow.GetPath()))
         {
             std::cerr << "Invalid rainbow table file" << std::endl;
             return 1;
@@ -225,10 +508,38 @@ main(
         std::cout << "Min:         " << rainbow.GetMin() << std::endl;
         std::cout << "Max:         " << rainbow.GetMax() << std::endl;
         std::cout << "Length:      " << rainbow.GetLength() << std::endl;
+        std::cout << "Table Index: " << rainbow.GetTableIndex() << std::endl;
         std::cout << "Count:       " << rainbow.GetCount() << std::endl;
         std::cout << "Charset:     \"" << rainbow.GetCharset() << "\"" << std::endl;
         std::cout << "Charset Len: " << rainbow.GetCharset().size() << std::endl;
         std::cout << "KS Coverage: " << rainbow.GetCoverage() << std::endl;
+        std::cout << "Success:     " << rainbow.GetSuccessProbability() * 100 << "%" << std::endl;
+        for (const TableShard& shard : rainbow.GetShards())
+        {
+            std::cout << "Shard:       " << std::hex << std::setfill('0') << std::setw(4) << shard.first << "-" << std::setw(4) << shard.last;
+            std::cout << std::dec << " " << shard.chains << " chains " << shard.path << std::endl;
+        }
+        if (rainbow.GetTableType() == TypeFingerprint)
+        {
+            // Each false alarm regenerates the chain up to its column,
+            // on average L/2 hashes, about the L/2 hashes it took to
+            // compute the endpoint looked up. So f per lookup adds f
+            const double falseAlarms = rainbow.GetFalseAlarmRate();
+            std::cout << "FP Bits:     " << rainbow.GetFingerprintBits() << std::endl;
+            std::cout << "Index Bits:  " << rainbow.GetIndexBits() << std::endl;
+            std::cout << "Chain Bits:  " << rainbow.GetFingerprintBits() + rainbow.GetIndexBits() << std::endl;
+            std::cout << "False Alarm: " << falseAlarms << " per lookup, "
+                      << falseAlarms * rainbow.GetLength() << " per hash (+"
+                      << falseAlarms * 100.f << "% hashing)" << std::endl;
+        }
+        else if (rainbow.GetTableType() == TypeDelta)
+        {
+            const double uncompressedBits = RainbowTable::ChainWidthForType(TypeUncompressed, rainbow.GetMax()) * 8;
+            std::cout << "Delta Bits:  " << rainbow.GetDeltaBits() << std::endl;
+            std::cout << "Index Bits:  " << rainbow.GetIndexBits() << std::endl;
+            std::cout << "Chain Bits:  " << rainbow.GetBitsPerChain() << " ("
+                      << uncompressedBits / rainbow.GetBitsPerChain() << "x smaller than uncompressed)" << std::endl;
+        }
     }
     else if (action == "test")
     {
@@ -0,0 +1,220 @@
+//
+//  lookupperf.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RainbowTable.hpp"
+
+// Compares endpoint lookup latency across table layouts.
+// Takes a compressed or uncompressed table and converts it
+// to each of the searchable layouts alongside the original
+
+// Read every endpoint out of an uncompressed table so
+// that we have a set of known hits to look up
+std::vector<std::string>
+ReadEndpoints(
+    const std::filesystem::path& Path,
+    const size_t Max
+)
+{
+    std::vector<std::string> endpoints;
+    FILE* fh = fopen(Path.c_str(), "r");
+    if (fh == nullptr)
+    {
+        return endpoints;
+    }
+
+    fseek(fh, sizeof(TableHeader), SEEK_SET);
+    std::vector<uint8_t> record(sizeof(rowindex_t) + Max);
+    while (fread(&record[0], record.size(), 1, fh) == 1)
+    {
+        const char* const endpoint = (char*)&record[sizeof(rowindex_t)];
+        endpoints.emplace_back(endpoint, strnlen(endpoint, Max));
+    }
+    fclose(fh);
+    return endpoints;
+}
+
+void
+TestLayout(
+    const std::filesystem::path& Path,
+    const std::vector<std::string>& Hits,
+    const std::vector<std::string>& Misses,
+    const bool Learned = false,
+    const size_t FilterBits = 0
+)
+{
+    using std::chrono::high_resolution_clock;
+    using std::chrono::duration;
+
+    // Not every table can be converted to every layout
+    if (!std::filesystem::exists(Path))
+    {
+        return;
+    }
+
+    RainbowTable rainbow;
+    rainbow.SetPath(Path);
+    if (Learned)
+    {
+        rainbow.EnableLearnedIndex();
+    }
+    rainbow.SetFilterBits(FilterBits);
+    if (!rainbow.LoadTable() || !rainbow.PrepareLookup())
+    {
+        std::cerr << "Unable to load " << Path << std::endl;
+        return;
+    }
+
+    std::cout << rainbow.GetType() << (Learned ? " (learned)" : "");
+    if (FilterBits > 0)
+    {
+        std::cout << " (" << FilterBits << " bit filter)";
+    }
+    std::cout << std::endl;
+    for (const auto* set : {&Hits, &Misses})
+    {
+        size_t found = 0;
+        auto t1 = high_resolution_clock::now();
+        for (const auto& endpoint : *set)
+        {
+            found += rainbow.FindEndpoint(endpoint.c_str(), endpoint.size()) != (size_t)-1;
+        }
+        auto t2 = high_resolution_clock::now();
+        duration<double, std::nano> ns = t2 - t1;
+        std::cout << "  " << (set == &Hits ? "Hits:   " : "Misses: ");
+        std::cout << ns.count() / set->size() << "ns/lookup (" << found << " found)" << std::endl;
+    }
+}
+
+// Lookups are issued in batches to measure throughput
+// rather than the latency of a single lookup
+void
+TestBatched(
+    const std::filesystem::path& Path,
+    const std::vector<std::string>& Hits,
+    const std::vector<std::string>& Misses,
+    const size_t BatchSize
+)
+{
+    using std::chrono::high_resolution_clock;
+    using std::chrono::duration;
+
+    if (!std::filesystem::exists(Path))
+    {
+        return;
+    }
+
+    RainbowTable rainbow;
+    rainbow.SetPath(Path);
+    if (!rainbow.LoadTable() || !rainbow.PrepareLookup())
+    {
+        std::cerr << "Unable to load " << Path << std::endl;
+        return;
+    }
+
+    std::cout << rainbow.GetType() << " (batches of " << BatchSize << ")" << std::endl;
+    for (const auto* set : {&Hits, &Misses})
+    {
+        size_t found = 0;
+        auto t1 = high_resolution_clock::now();
+        for (size_t i = 0; i < set->size(); i += BatchSize)
+        {
+            const std::vector<std::string> batch(set->begin() + i, set->begin() + std::min(i + BatchSize, set->size()));
+            for (const size_t result : rainbow.FindEndpoints(batch))
+            {
+                found += result != (size_t)-1;
+            }
+        }
+        auto t2 = high_resolution_clock::now();
+        duration<double, std::nano> ns = t2 - t1;
+        std::cout << "  " << (set == &Hits ? "Hits:   " : "Misses: ");
+        std::cout << ns.count() / set->size() << "ns/lookup, " << set->size() * 1e3 / ns.count() << "M lookups/s (" << found << " found)" << std::endl;
+    }
+}
+
+int main(
+    int argc,
+    char* argv[]
+)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <table> [lookups]" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path path = argv[1];
+    const size_t lookups = argc > 2 ? std::stoull(argv[2]) : 1000000;
+
+    RainbowTable rainbow;
+    rainbow.SetPath(path);
+    if (!rainbow.ValidTable() || !rainbow.LoadTable())
+    {
+        std::cerr << "Unable to load " << path << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path uncompressed = path;
+    uncompressed.replace_extension(".perf.utbl");
+    std::filesystem::path eytzinger = path;
+    eytzinger.replace_extension(".perf.etbl");
+    std::filesystem::path columnar = path;
+    columnar.replace_extension(".perf.ctbl");
+    std::filesystem::path delta = path;
+    delta.replace_extension(".perf.dtbl");
+
+    rainbow.Decompress(uncompressed, TypeUncompressed);
+    rainbow.Decompress(eytzinger, TypeEytzinger);
+    rainbow.Decompress(columnar, TypeColumnar);
+    rainbow.Decompress(delta, TypeDelta);
+
+    // Hits are drawn from the table itself, misses are random words
+    // of the maximum length which are very unlikely to be endpoints
+    auto endpoints = ReadEndpoints(uncompressed, rainbow.GetMax());
+    if (endpoints.empty())
+    {
+        std::cerr << "No endpoints found" << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 random(0);
+    const std::string& charset = rainbow.GetCharset();
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    for (size_t i = 0; i < lookups; i++)
+    {
+        hits.push_back(endpoints[random() % endpoints.size()]);
+        std::string word(rainbow.GetMax(), '\0');
+        for (auto& c : word)
+        {
+            c = charset[random() % charset.size()];
+        }
+        misses.push_back(word);
+    }
+
+    TestLayout(uncompressed, hits, misses);
+    TestLayout(eytzinger, hits, misses);
+    TestLayout(columnar, hits, misses);
+    TestLayout(columnar, hits, misses, true);
+    TestLayout(uncompressed, hits, misses, false, 12);
+    TestLayout(columnar, hits, misses, true, 12);
+    TestBatched(uncompressed, hits, misses, 1024);
+    TestLayout(delta, hits, misses);
+
+    std::filesystem::remove(uncompressed);
+    std::filesystem::remove(eytzinger);
+    std::filesystem::remove(columnar);
+    std::filesystem::remove(columnar.string() + ".lidx");
+    std::filesystem::remove(delta);
+}
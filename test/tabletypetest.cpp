@@ -0,0 +1,906 @@
+//
+//  tabletypetest.cpp
+//  SimdRainbowCrack
+//
+//  Created by Kryc on 18/10/2026.
+//  Copyright © 2026 Kryc. All rights reserved.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "simdhash.h"
+
+#include "RainbowTable.hpp"
+#include "Util.hpp"
+#include "WordGenerator.hpp"
+
+#define MIN 6
+#define MAX 6
+#define LENGTH 64
+#define COUNT 256
+
+// Walk a chain to the given column and return the hash
+// of the word found there along with the word itself
+std::tuple<std::string, std::string>
+GetAtOffset(
+    const size_t Chain,
+    const size_t Offset,
+    const size_t TableIndex = 0
+)
+{
+    const size_t hashWidth = GetHashWidth(HashAlgorithmSHA1);
+    HybridReducer reducer(MIN, MAX, hashWidth, LOWER, TableIndex);
+    mpz_class counter = WordGenerator::WordLengthIndex(MIN, LOWER) + Chain;
+    std::string word = WordGenerator::GenerateWord(counter, LOWER);
+    std::vector<uint8_t> hash(hashWidth);
+    std::vector<char> reduced(MAX);
+
+    for (size_t i = 0; i < Offset; i++)
+    {
+        RainbowTable::DoHash((uint8_t*)&word[0], word.size(), &hash[0], HashAlgorithmSHA1);
+        size_t length = reducer.Reduce(&reduced[0], MAX, &hash[0], i);
+        word = std::string(&reduced[0], &reduced[length]);
+    }
+
+    return {RainbowTable::DoHashHex((uint8_t*)&word[0], word.size(), HashAlgorithmSHA1), word};
+}
+
+// Each extra build runs in a child process of its own so that
+// it gets a fresh main dispatcher
+bool
+BuildInChild(
+    const std::filesystem::path& Path,
+    const std::function<void(RainbowTable&)>& Configure
+)
+{
+    std::filesystem::remove(Path);
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        RainbowTable rainbow;
+        rainbow.SetPath(Path);
+        rainbow.SetCharset("lower");
+        rainbow.SetMin(MIN);
+        rainbow.SetMax(MAX);
+        rainbow.SetLength(LENGTH);
+        rainbow.SetAlgorithm("sha1");
+        rainbow.SetThreads(1);
+        rainbow.SetBlocksize(64);
+        rainbow.SetCount(COUNT);
+        Configure(rainbow);
+
+        auto mainDispatcher = dispatch::CreateDispatcher("main");
+        dispatch::PostTaskToDispatcher(
+            mainDispatcher,
+            dispatch::bind(
+                &RainbowTable::InitAndRunBuild,
+                &rainbow
+            )
+        );
+        mainDispatcher->Wait();
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && std::filesystem::exists(Path);
+}
+
+// A targeted build must stop once it reaches the goal rather
+// than building every chain it was allowed
+bool
+CheckTargetSuccess(
+    void
+)
+{
+    const std::filesystem::path path = "tabletype.target.tbl";
+    const double target = 0.5;
+    const size_t length = 4;
+    if (!BuildInChild(path, [&](RainbowTable& Table) {
+            Table.SetMin(length);
+            Table.SetMax(length);
+            Table.SetCount(0);
+            Table.SetTargetSuccess(target);
+        }))
+    {
+        std::cerr << path << ": unable to build" << std::endl;
+        return false;
+    }
+
+    RainbowTable rainbow;
+    rainbow.SetPath(path);
+    rainbow.LoadTable();
+    const double success = rainbow.GetSuccessProbability();
+    const size_t chains = rainbow.GetCount();
+    std::filesystem::remove(path);
+
+    // Merges are discounted from the estimate the build stops on,
+    // so the model may overshoot slightly but never falls short
+    if (success < target || success > target + 0.02)
+    {
+        std::cerr << path << ": stopped at " << success * 100 << "% success with " << chains << " chains" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A budget too short to search every column of a long table must
+// stop early, report the miss and have searched the cheapest columns
+bool
+CheckBudget(
+    void
+)
+{
+    const std::filesystem::path path = "tabletype.budget.tbl";
+    const size_t length = 20000;
+    if (!BuildInChild(path, [&](RainbowTable& Table) { Table.SetLength(length); Table.SetCount(64); }))
+    {
+        std::cerr << path << ": unable to build" << std::endl;
+        return false;
+    }
+
+    RainbowTable rainbow;
+    rainbow.SetPath(path);
+    rainbow.SetThreads(1);
+    rainbow.SetBudget(100);
+    if (!rainbow.LoadTable())
+    {
+        std::cerr << path << ": unable to load table" << std::endl;
+        return false;
+    }
+
+    // Upper case words are outside the charset so this always misses
+    const std::string word = "MISSED";
+    std::string hash = RainbowTable::DoHashHex((uint8_t*)&word[0], word.size(), HashAlgorithmSHA1);
+    std::stringstream report;
+    std::streambuf* original = std::cerr.rdbuf(report.rdbuf());
+    const auto results = rainbow.Crack(hash);
+    std::cerr.rdbuf(original);
+    std::filesystem::remove(path);
+
+    const std::vector<uint8_t>& searched = rainbow.GetColumnsSearched();
+    const size_t first = std::find(searched.begin(), searched.end(), 1) - searched.begin();
+    const bool cheapest = first > 0 && first < length && std::all_of(searched.begin() + first, searched.end(), [](const uint8_t Searched) { return Searched == 1; });
+    const double probability = rainbow.GetLastProbability();
+    if (!results.empty() || !rainbow.BudgetExceeded() || !cheapest || probability <= 0 || probability >= rainbow.GetSuccessProbability() ||
+        report.str().find("not found within budget") == std::string::npos)
+    {
+        std::cerr << path << ": budget crack searched from column " << first << " with " << probability * 100 << "% success" << std::endl << report.str();
+        return false;
+    }
+    return true;
+}
+
+// The recommended shape must fit the budget and reach the target
+bool
+CheckPlan(
+    void
+)
+{
+    RainbowTable rainbow;
+    rainbow.SetAlgorithm("sha1");
+    rainbow.SetCharset("lower");
+    rainbow.SetMin(4);
+    rainbow.SetMax(4);
+    rainbow.SetThreads(1);
+    rainbow.SetTargetSuccess(0.9);
+
+    const size_t space = 64 * 1024;
+    TablePlan plan;
+    if (!rainbow.Plan(space, &plan))
+    {
+        std::cerr << "Unable to plan a table" << std::endl;
+        return false;
+    }
+
+    if (plan.tables == 0 || plan.length == 0 || plan.size > space || plan.success < 0.9)
+    {
+        std::cerr << "Plan of " << plan.tables << " x " << plan.chains << " chains of " << plan.length << " is outside the budget or target" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool
+CheckTable(
+    const std::filesystem::path& Path,
+    const TableType Type,
+    const bool Learned = false,
+    const size_t FilterBits = 0,
+    const std::string& Storage = "mmap"
+)
+{
+    RainbowTable rainbow;
+    rainbow.SetPath(Path);
+    rainbow.SetThreads(1);
+    rainbow.SetStorage(Storage);
+    if (Learned)
+    {
+        rainbow.EnableLearnedIndex();
+    }
+    rainbow.SetFilterBits(FilterBits);
+
+    if (!rainbow.ValidTable() || !rainbow.LoadTable())
+    {
+        std::cerr << Path << ": unable to load table" << std::endl;
+        return false;
+    }
+
+    if (rainbow.GetTableType() != Type)
+    {
+        std::cerr << Path << ": unexpected type " << rainbow.GetType() << std::endl;
+        return false;
+    }
+
+    if (rainbow.GetCount() != COUNT)
+    {
+        std::cerr << Path << ": unexpected count " << rainbow.GetCount() << std::endl;
+        return false;
+    }
+
+    bool error = false;
+    for (size_t i = 0; i < 16; i++)
+    {
+        auto [hash, word] = GetAtOffset(i * 13 % COUNT, i * 7 % LENGTH);
+        auto results = rainbow.Crack(hash);
+        if (results.size() != 1 || std::get<1>(results[0]) != word)
+        {
+            std::cerr << Path << ": failed to crack " << hash << " (" << word << ")" << std::endl;
+            error = true;
+        }
+    }
+    return !error;
+}
+
+// Every crack mode must recover the same hashes as the default
+// path. Brute force also finds a word the table does not hold
+bool
+CheckCrackModes(
+    const std::filesystem::path& Path,
+    const std::filesystem::path& FingerprintPath
+)
+{
+    const std::string hashes = "tabletype.hashes";
+    std::ofstream stream(hashes);
+    for (size_t i = 0; i < 16; i++)
+    {
+        auto [hash, word] = GetAtOffset(i * 13 % COUNT, i * 7 % LENGTH);
+        stream << hash << std::endl;
+    }
+    const uint64_t first = WordGenerator::WordLengthIndex(MIN, LOWER).get_ui();
+    std::string extra(MIN, '\0');
+    WordGenerator::GenerateWordFixed(&extra[0], MIN, 700, LOWER);
+    const std::string extraHash = RainbowTable::DoHashHex((uint8_t*)&extra[0], extra.size(), HashAlgorithmSHA1);
+    stream << extraHash << std::endl;
+    stream.close();
+
+    auto crack = [&](const std::filesystem::path& Table, const size_t Threads, const std::function<void(RainbowTable&)>& Configure) {
+        RainbowTable rainbow;
+        rainbow.SetPath(Table);
+        rainbow.SetThreads(Threads);
+        Configure(rainbow);
+        std::set<std::string> found;
+        if (!rainbow.LoadTable())
+        {
+            return found;
+        }
+        std::string target = hashes;
+        for (const auto& [hash, word] : rainbow.Crack(target))
+        {
+            found.insert(hash + ":" + word);
+        }
+        return found;
+    };
+
+    bool error = false;
+    const std::set<std::string> expected = crack(Path, 1, [](RainbowTable&) {});
+    if (expected.size() != 16)
+    {
+        std::cerr << Path << ": default crack found " << expected.size() << " of 16" << std::endl;
+        return false;
+    }
+
+    const std::vector<std::tuple<std::string, std::filesystem::path, size_t, std::function<void(RainbowTable&)>>> modes = {
+        {"merge join", Path, 2, [](RainbowTable& Table) { Table.EnableMergeJoin(); }},
+        {"table scan", Path, 2, [](RainbowTable& Table) { Table.EnableTableScan(); }},
+        {"scheduled", Path, 2, [](RainbowTable& Table) { Table.EnableScheduler(); }},
+        {"budget", Path, 1, [](RainbowTable& Table) { Table.SetBudget(60000); }},
+        {"pipeline", Path, 2, [](RainbowTable& Table) { Table.EnablePipeline(); }},
+        {"pipeline", FingerprintPath, 2, [](RainbowTable& Table) { Table.EnablePipeline(); }},
+    };
+    for (const auto& [name, table, threads, configure] : modes)
+    {
+        if (crack(table, threads, configure) != expected)
+        {
+            std::cerr << table << ": " << name << " crack differs from the default" << std::endl;
+            error = true;
+        }
+    }
+
+    // Every shorter word and the first 1000 of the table's length
+    std::set<std::string> bruteForced = expected;
+    bruteForced.insert(extraHash + ":" + extra);
+    const std::set<std::string> found = crack(Path, 2, [first](RainbowTable& Table) {
+        Table.SetBruteForceLength(MAX);
+        Table.SetBruteForceLimit(first + 1000);
+    });
+    if (found != bruteForced)
+    {
+        std::cerr << Path << ": brute force crack differs from the default" << std::endl;
+        error = true;
+    }
+
+    std::filesystem::remove(hashes);
+    return !error;
+}
+
+// A second table sharing the index must attach to the segments
+// made by the first, and both must crack the same hashes until the
+// segments are removed
+bool
+CheckSharedIndex(
+    const std::filesystem::path& Path
+)
+{
+    std::vector<std::unique_ptr<RainbowTable>> tables;
+    for (size_t i = 0; i < 2; i++)
+    {
+        auto table = std::make_unique<RainbowTable>();
+        table->SetPath(Path);
+        table->SetThreads(1);
+        table->SetStorage("shared");
+        table->EnableSharedIndex();
+        if (!table->LoadTable())
+        {
+            std::cerr << Path << ": unable to load shared table" << std::endl;
+            return false;
+        }
+        tables.push_back(std::move(table));
+    }
+
+    // The index is made on the first lookup
+    bool error = false;
+    std::stringstream report;
+    std::streambuf* original = std::cerr.rdbuf(report.rdbuf());
+    for (size_t i = 0; i < 16; i++)
+    {
+        auto [hash, word] = GetAtOffset(i * 13 % COUNT, i * 7 % LENGTH);
+        for (auto& table : tables)
+        {
+            auto results = table->Crack(hash);
+            if (results.size() != 1 || std::get<1>(results[0]) != word)
+            {
+                std::cout << Path << ": failed to crack " << hash << " (" << word << ") through the shared index" << std::endl;
+                error = true;
+            }
+        }
+    }
+    std::cerr.rdbuf(original);
+
+    const std::string output = report.str();
+    const size_t indexed = output.find("Indexing table into");
+    if (indexed == std::string::npos || output.find("Indexing table into", indexed + 1) != std::string::npos ||
+        output.find("Attached shared index") == std::string::npos)
+    {
+        std::cerr << Path << ": second table did not attach to the shared index" << std::endl << output;
+        error = true;
+    }
+
+    // The table and its index, then nothing left to remove
+    const size_t removed = tables[0]->Unshare();
+    if (removed != 2 || tables[1]->Unshare() != 0)
+    {
+        std::cerr << Path << ": removed " << removed << " shared segments rather than 2" << std::endl;
+        error = true;
+    }
+    return !error;
+}
+
+// Run analyze and return its report, or nothing on failure
+std::string
+AnalyzeReport(
+    const std::filesystem::path& Path,
+    const std::string& Storage
+)
+{
+    RainbowTable rainbow;
+    rainbow.SetPath(Path);
+    rainbow.SetThreads(2);
+    rainbow.SetStorage(Storage);
+    rainbow.LoadTable();
+
+    std::stringstream report;
+    std::streambuf* original = std::cout.rdbuf(report.rdbuf());
+    const bool analyzed = rainbow.Analyze();
+    std::cout.rdbuf(original);
+    if (!analyzed)
+    {
+        std::cerr << Path << ": unable to analyze with " << Storage << std::endl;
+        return "";
+    }
+    return report.str();
+}
+
+// The distinct words a report says the table covers
+double
+EffectiveWords(
+    const std::string& Report
+)
+{
+    const std::string label = "Effective:   ";
+    const size_t offset = Report.find(label);
+    return offset == std::string::npos ? 0.0 : std::stod(Report.substr(offset + label.size()));
+}
+
+// Unmapped storage reads records into a shared buffer, which
+// must not change what analyze reports. Storing every chain twice
+// doubles the chains but adds no words, so the effective coverage
+// must stay where it was
+bool
+CheckAnalyze(
+    const std::filesystem::path& Path
+)
+{
+    const std::string mapped = AnalyzeReport(Path, "mmap");
+    const std::string unmapped = AnalyzeReport(Path, "pread");
+    if (mapped.find("Unique:      " + std::to_string(COUNT) + " ") == std::string::npos || mapped != unmapped)
+    {
+        std::cerr << Path << ": analyze reports differ" << std::endl << mapped << unmapped;
+        return false;
+    }
+
+    RainbowTable rainbow;
+    rainbow.SetPath(Path);
+    if (!rainbow.LoadTable())
+    {
+        std::cerr << Path << ": unable to load table" << std::endl;
+        return false;
+    }
+    const size_t width = rainbow.GetChainWidth();
+    std::ifstream input(Path, std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    const std::filesystem::path duplicated = "tabletype.dup.utbl";
+    std::ofstream output(duplicated, std::ios::binary);
+    output.write(&contents[0], sizeof(TableHeader));
+    for (size_t offset = sizeof(TableHeader); offset + width <= contents.size(); offset += width)
+    {
+        output.write(&contents[offset], width);
+        output.write(&contents[offset], width);
+    }
+    output.close();
+
+    const std::string report = AnalyzeReport(duplicated, "mmap");
+    std::filesystem::remove(duplicated);
+    const double clean = EffectiveWords(mapped);
+    const double merged = EffectiveWords(report);
+    if (report.find("Chains:      " + std::to_string(COUNT * 2)) == std::string::npos || clean <= 0 || std::abs(merged - clean) > clean * 0.01)
+    {
+        std::cerr << duplicated << ": effective coverage " << merged << " differs from " << clean << std::endl << report;
+        return false;
+    }
+    return true;
+}
+
+// Words only in the second member must be found through the first
+bool
+CheckFamily(
+    const std::filesystem::path& Path
+)
+{
+    RainbowTable family;
+    family.SetPath(Path);
+    family.SetThreads(1);
+    family.SetFamily(2);
+    if (!family.LoadTable())
+    {
+        std::cerr << Path << ": unable to load table" << std::endl;
+        return false;
+    }
+
+    bool error = false;
+    for (size_t i = 0; i < 16; i++)
+    {
+        auto [hash, word] = GetAtOffset(i * 13 % COUNT, i * 7 % LENGTH, 1);
+        auto results = family.Crack(hash);
+        if (results.size() != 1 || std::get<1>(results[0]) != word)
+        {
+            std::cerr << Path << ": failed to crack " << hash << " (" << word << ")" << std::endl;
+            error = true;
+        }
+    }
+    return !error;
+}
+
+// Chains read from either unpacked type must hold the same endpoints
+// and the packed types, which have no records to seek to, none at all
+bool
+CheckGetChain(
+    const std::filesystem::path& Compressed,
+    const std::filesystem::path& Uncompressed,
+    const std::vector<std::filesystem::path>& Packed
+)
+{
+    std::multiset<std::string> compressed;
+    std::multiset<std::string> uncompressed;
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        compressed.insert(RainbowTable::GetChain(Compressed, i).End());
+        uncompressed.insert(RainbowTable::GetChain(Uncompressed, i).End());
+    }
+
+    bool error = false;
+    if (compressed != uncompressed || compressed.count("") > 0)
+    {
+        std::cerr << Compressed << ": chains differ from " << Uncompressed << std::endl;
+        error = true;
+    }
+
+    std::stringstream report;
+    std::streambuf* original = std::cerr.rdbuf(report.rdbuf());
+    for (const auto& path : Packed)
+    {
+        if (!RainbowTable::GetChain(path, COUNT / 2).End().empty())
+        {
+            std::cerr.rdbuf(original);
+            std::cerr << path << ": read a chain from a packed table" << std::endl;
+            original = std::cerr.rdbuf(report.rdbuf());
+            error = true;
+        }
+    }
+    std::cerr.rdbuf(original);
+    return !error;
+}
+
+// Hashes solved by one member are skipped by the next whatever their
+// case. Start words are in column 0 of every member so an upper case
+// hash not matched against the first member's result is found twice
+bool
+CheckSolvedCase(
+    const std::filesystem::path& Path
+)
+{
+    const std::string hashes = "tabletype.upper.hashes";
+    auto [hash, word] = GetAtOffset(5, 0);
+    std::transform(hash.begin(), hash.end(), hash.begin(), ::toupper);
+    std::ofstream(hashes) << hash << std::endl;
+
+    RainbowTable family;
+    family.SetPath(Path);
+    family.SetThreads(1);
+    family.SetFamily(2);
+    if (!family.LoadTable())
+    {
+        std::cerr << Path << ": unable to load table" << std::endl;
+        return false;
+    }
+
+    std::string target = hashes;
+    const auto results = family.Crack(target);
+    std::filesystem::remove(hashes);
+    if (results.size() != 1 || std::get<1>(results[0]) != word)
+    {
+        std::cerr << Path << ": upper case hash cracked " << results.size() << " times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A batched lookup must agree with looking up each endpoint on its
+// own. The batch holds hits, misses sharing a hit's index bucket and
+// misses in empty buckets, and does not fill its last group
+bool
+CheckFindEndpoints(
+    const std::filesystem::path& Path
+)
+{
+    std::set<std::string> endpoints;
+    std::map<uint16_t, size_t> buckets;
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        std::string endpoint = RainbowTable::GetChain(Path, i).End();
+        endpoints.insert(endpoint);
+        endpoint.resize(MAX);
+        buckets[*(uint16_t*)&endpoint[0]]++;
+    }
+
+    std::vector<std::string> batch;
+    bool single = false;
+    for (const std::string& endpoint : endpoints)
+    {
+        if (batch.size() >= kLookupGroupSize * 2 + 5)
+        {
+            break;
+        }
+        batch.push_back(endpoint);
+        single |= buckets[*(uint16_t*)&endpoint[0]] == 1;
+
+        std::string miss = endpoint;
+        for (miss.back() = '0'; endpoints.count(miss) > 0; miss.back()++);
+        batch.push_back(miss);
+        batch.push_back(std::string("\x01\x01", 2) + endpoint.substr(2));
+    }
+    batch.resize(kLookupGroupSize * 2 + 5);
+
+    if (!single)
+    {
+        std::cerr << Path << ": no endpoint in an index bucket of size 1" << std::endl;
+        return false;
+    }
+
+    const std::vector<std::tuple<size_t, bool>> configurations = {
+        {0, true},
+        {8, true},
+        {0, false},
+    };
+
+    bool error = false;
+    for (const auto& [filterBits, indexed] : configurations)
+    {
+        RainbowTable rainbow;
+        rainbow.SetPath(Path);
+        rainbow.SetThreads(1);
+        rainbow.SetFilterBits(filterBits);
+        if (!indexed)
+        {
+            rainbow.DisableIndex();
+        }
+        if (!rainbow.LoadTable() || !rainbow.PrepareLookup())
+        {
+            std::cerr << Path << ": unable to load table" << std::endl;
+            return false;
+        }
+
+        const std::vector<size_t> results = rainbow.FindEndpoints(batch);
+        size_t found = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            const size_t expected = rainbow.FindEndpoint(batch[i].c_str(), batch[i].size());
+            found += expected != (size_t)-1;
+            if (results[i] != expected)
+            {
+                std::cerr << Path << ": batched lookup of endpoint " << i << " returned " << results[i]
+                          << " not " << expected << " (filter " << filterBits << ", indexed " << indexed << ")" << std::endl;
+                error = true;
+            }
+        }
+
+        // Every third endpoint is a hit
+        if (found != (batch.size() + 2) / 3)
+        {
+            std::cerr << Path << ": found " << found << " of " << (batch.size() + 2) / 3 << " endpoints" << std::endl;
+            error = true;
+        }
+    }
+    return !error;
+}
+
+// A reset table must forget the shards, filter and results of the
+// table it had loaded. Each table is loaded into the same object
+// and the last holds different chains to the others
+bool
+CheckReset(
+    const std::filesystem::path& Manifest,
+    const std::filesystem::path& Path,
+    const std::filesystem::path& Member
+)
+{
+    const std::vector<std::tuple<std::filesystem::path, size_t, size_t>> stages = {
+        {Manifest, 0, 0},
+        {Path, 0, 8},
+        {Member, 1, 0},
+    };
+
+    RainbowTable rainbow;
+    bool error = false;
+    for (const auto& [path, index, filterBits] : stages)
+    {
+        rainbow.Reset();
+        rainbow.SetPath(path);
+        rainbow.SetThreads(1);
+        rainbow.SetFilterBits(filterBits);
+        if (!rainbow.LoadTable())
+        {
+            std::cerr << path << ": unable to load table after a reset" << std::endl;
+            return false;
+        }
+
+        for (size_t i = 0; i < 16; i++)
+        {
+            auto [hash, word] = GetAtOffset(i * 13 % COUNT, i * 7 % LENGTH, index);
+            auto results = rainbow.Crack(hash);
+            if (results.size() != 1 || std::get<1>(results[0]) != word)
+            {
+                std::cerr << path << ": failed to crack " << hash << " (" << word << ") after a reset" << std::endl;
+                error = true;
+            }
+        }
+    }
+    return !error;
+}
+
+// Serve each shard from its own process, standing in for
+// separate machines, and crack through them
+bool
+CheckRemoteShards(
+    const std::filesystem::path& Directory,
+    const std::string& Manifest
+)
+{
+    std::ifstream local(Directory / Manifest);
+    std::ofstream remote(Directory / "remote.manifest");
+    std::vector<pid_t> servers;
+    std::string line;
+    while (std::getline(local, line))
+    {
+        if (!line.starts_with("shard "))
+        {
+            remote << line << std::endl;
+            continue;
+        }
+
+        const std::string shard = line.substr(line.rfind(' ') + 1);
+        const std::filesystem::path socket = std::filesystem::absolute(Directory / (shard + ".sock"));
+        std::filesystem::remove(socket);
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            RainbowTable server;
+            server.SetPath(Directory / shard);
+            server.SetThreads(1);
+            server.LoadTable();
+            server.Serve("unix://" + socket.string());
+            _exit(1);
+        }
+        servers.push_back(pid);
+        remote << line.substr(0, line.rfind(' ') + 1) << "unix://" << socket.string() << std::endl;
+
+        // Wait for the server to bind and start listening
+        for (size_t i = 0; i < 500 && !std::filesystem::exists(socket); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    remote.close();
+
+    const bool result = CheckTable(Directory / "remote.manifest", TypeUncompressed);
+    for (const pid_t pid : servers)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    return result;
+}
+
+int main(
+    int argc,
+    char* argv[]
+)
+{
+    // The extra builds run before this process starts its own
+    bool error = false;
+    error |= !CheckTargetSuccess();
+    error |= !CheckBudget();
+    error |= !CheckPlan();
+
+    std::filesystem::remove("tabletype.tbl");
+    std::filesystem::remove("tabletype.t1.tbl");
+
+    // The first member reduces like any other table so the checks
+    // below cover it, the second is only searched through the family
+    RainbowTable rainbow;
+    rainbow.SetPath("tabletype.tbl");
+    rainbow.SetCharset("lower");
+    rainbow.SetMin(MIN);
+    rainbow.SetMax(MAX);
+    rainbow.SetLength(LENGTH);
+    rainbow.SetAlgorithm("sha1");
+    rainbow.SetThreads(1);
+    rainbow.SetBlocksize(64);
+    rainbow.SetCount(COUNT);
+    rainbow.SetFamily(2);
+
+    auto mainDispatcher = dispatch::CreateDispatcher("main");
+
+    dispatch::PostTaskToDispatcher(
+        mainDispatcher,
+        dispatch::bind(
+            &RainbowTable::InitAndRunBuild,
+            &rainbow
+        )
+    );
+
+    mainDispatcher->Wait();
+
+    rainbow.Reset();
+    rainbow.SetPath("tabletype.tbl");
+    rainbow.LoadTable();
+    rainbow.Decompress("tabletype.utbl");
+
+    // Use a small fingerprint to force false alarms
+    RainbowTable uncompressed;
+    uncompressed.SetPath("tabletype.utbl");
+    uncompressed.LoadTable();
+    uncompressed.SetFingerprintBits(12);
+    uncompressed.Decompress("tabletype.ftbl", TypeFingerprint);
+    uncompressed.Decompress("tabletype.dtbl", TypeDelta);
+    uncompressed.Decompress("tabletype.etbl", TypeEytzinger);
+    uncompressed.Split("tabletype.shards", 3);
+    // The table itself is the first input and the shards partition
+    // it, so every endpoint appears twice and only one copy is kept
+    if (!uncompressed.Merge({"tabletype.shards/tabletype.0.utbl", "tabletype.shards/tabletype.1.utbl", "tabletype.shards/tabletype.2.utbl"}, "tabletype.merged.utbl"))
+    {
+        std::cerr << "Unable to merge the table with its shards" << std::endl;
+        error = true;
+    }
+    // A missing input is reported rather than thrown
+    if (uncompressed.Merge({"tabletype.missing.utbl"}, "tabletype.merged.utbl"))
+    {
+        std::cerr << "Merged a missing table" << std::endl;
+        error = true;
+    }
+    rainbow.Decompress("tabletype.ctbl", TypeColumnar);
+
+    error |= !CheckTable("tabletype.tbl", TypeCompressed);
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed);
+    error |= !CheckTable("tabletype.ftbl", TypeFingerprint);
+    error |= !CheckTable("tabletype.dtbl", TypeDelta);
+    error |= !CheckTable("tabletype.etbl", TypeEytzinger);
+    // Exact keys leave only the start index in each record
+    if (std::filesystem::file_size("tabletype.etbl") != kAlignedDataOffset + (COUNT + 1) * (sizeof(uint64_t) + sizeof(rowindex_t)))
+    {
+        std::cerr << "tabletype.etbl: records hold more than the start index" << std::endl;
+        error = true;
+    }
+    error |= !CheckTable("tabletype.ctbl", TypeColumnar);
+    std::filesystem::remove("tabletype.ctbl.lidx");
+    error |= !CheckTable("tabletype.ctbl", TypeColumnar, true);
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed, false, 8);
+    error |= !CheckTable("tabletype.shards/tabletype.manifest", TypeUncompressed);
+    // Only the COUNT unique chains of the 2 * COUNT merged remain
+    error |= !CheckTable("tabletype.merged.utbl", TypeUncompressed);
+    error |= !CheckRemoteShards("tabletype.shards", "tabletype.manifest");
+    error |= !CheckTable("tabletype.etbl", TypeEytzinger, false, 8);
+    error |= !CheckTable("tabletype.tbl", TypeCompressed, false, 0, "pread");
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed, false, 0, "pread");
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed, false, 0, "memory");
+    error |= !CheckTable("tabletype.etbl", TypeEytzinger, false, 0, "memory");
+    // The first loads the segment and the second attaches to it
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed, false, 0, "shared");
+    error |= !CheckTable("tabletype.utbl", TypeUncompressed, false, 0, "shared");
+    SharedSegment::Remove(SharedSegment::NameForFile("tabletype.utbl", "tbl"));
+    error |= !CheckSharedIndex("tabletype.utbl");
+    error |= !CheckFamily("tabletype.tbl");
+    error |= !CheckSolvedCase("tabletype.tbl");
+    error |= !CheckGetChain("tabletype.tbl", "tabletype.utbl", {"tabletype.ftbl", "tabletype.dtbl", "tabletype.etbl", "tabletype.ctbl"});
+    error |= !CheckFindEndpoints("tabletype.utbl");
+    error |= !CheckReset("tabletype.shards/tabletype.manifest", "tabletype.utbl", "tabletype.t1.tbl");
+    error |= !CheckAnalyze("tabletype.utbl");
+    error |= !CheckCrackModes("tabletype.utbl", "tabletype.ftbl");
+
+    if (error == false)
+    {
+        std::cout << "No issues found" << std::endl;
+    }
+    return error;
+}
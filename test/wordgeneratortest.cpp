@@ -7,6 +7,7 @@
 //
 
 #include <iostream>
+#include <set>
 #include <string>
 
 #include "gmpxx.h"
@@ -77,4 +78,18 @@ int main(
     {
         std::cerr << "Invalid word at index 2" << std::endl;
     }
+
+    // Fixed length words must cover every word of that length
+    std::set<std::string> words;
+    for (size_t i = 0; i < LOWER.size() * LOWER.size(); i++)
+    {
+        WordGenerator::GenerateWordFixed(buffer, 2, i, LOWER);
+        words.insert(std::string(buffer, 2));
+    }
+
+    if (words.size() != LOWER.size() * LOWER.size() || words.count("aa") == 0 || words.count("zz") == 0)
+    {
+        std::cerr << "Fixed length words do not cover the keyspace" << std::endl;
+        return -1;
+    }
 }
\ No newline at end of file